@@ -0,0 +1,230 @@
+/*
+ * Contention benchmark for the thread safe arenas. Every thread repeatedly
+ * allocates a batch of blocks and then releases them, half of each batch
+ * being handed to the next thread to release, so blocks regularly change
+ * threads like they would between producers and consumers. For every arena
+ * and thread count it prints one CSV row:
+ *
+ *   arena,threads,operations,ns_per_operation,million_operations_per_s
+ *
+ * "mutex" is the single threaded linked strategy behind a std::mutex, which
+ * is what the others replace. "malloc" is there for reference.
+ *
+ * usage: cpp-utilities-arena-benchmark [--max-threads N] [--operations N] [--arena NAME]
+ */
+
+#include "cpp-utilities/arena.h"
+#include "cpp-utilities/concurrent_arena.h"
+#include "cpp-utilities/time_code.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct message {
+	uint64_t words[8];
+};
+
+constexpr std::size_t Batch  = 32;
+constexpr std::size_t Blocks = 64 * 1024;
+
+// a mailbox whose owner isn't getting scheduled (or has already finished)
+// would otherwise soak up the whole arena
+constexpr std::size_t MailboxLimit = 1024;
+
+struct options {
+	std::size_t max_threads = 8;
+	std::size_t operations  = 4 * 1024 * 1024;
+	std::string arena;
+};
+
+class mutex_arena {
+public:
+	void *allocate() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return arena_.allocate();
+	}
+
+	void release(void *p) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		arena_.release(p);
+	}
+
+private:
+	std::mutex mutex_;
+	decltype(memory::make_arena<message, Blocks>()) arena_ = memory::make_arena<message, Blocks>();
+};
+
+class lockfree_arena {
+public:
+	void *allocate() {
+		return arena_.allocate();
+	}
+
+	void release(void *p) {
+		arena_.release(p);
+	}
+
+private:
+	decltype(memory::make_lockfree_arena<message, Blocks>()) arena_ = memory::make_lockfree_arena<message, Blocks>();
+};
+
+class magazine_arena {
+public:
+	void *allocate() {
+		return arena_.allocate();
+	}
+
+	void release(void *p) {
+		arena_.release(p);
+	}
+
+private:
+	decltype(memory::make_concurrent_arena<message>(0)) arena_ = memory::make_concurrent_arena<message>(Blocks);
+};
+
+class malloc_arena {
+public:
+	void *allocate() {
+		return std::malloc(sizeof(message));
+	}
+
+	void release(void *p) {
+		std::free(p);
+	}
+};
+
+// one per thread, where the previous thread leaves blocks for it to release
+struct mailbox {
+	std::mutex mutex;
+	std::vector<void *> blocks;
+};
+
+template <class Arena>
+void worker(Arena &arena, std::vector<mailbox> &mailboxes, std::size_t self, std::size_t operations) {
+	void *batch[Batch];
+	std::vector<void *> incoming;
+
+	mailbox &next = mailboxes[(self + 1) % mailboxes.size()];
+	mailbox &mine = mailboxes[self];
+
+	for (std::size_t done = 0; done < operations; done += 2 * Batch) {
+		for (std::size_t i = 0; i < Batch; ++i) {
+			while (!(batch[i] = arena.allocate())) {
+				std::this_thread::yield();
+			}
+			static_cast<message *>(batch[i])->words[0] = done + i;
+		}
+
+		// keep half, give half to the next thread
+		for (std::size_t i = 0; i < Batch / 2; ++i) {
+			arena.release(batch[i]);
+		}
+
+		bool handed_off = false;
+		{
+			std::lock_guard<std::mutex> lock(next.mutex);
+			if (next.blocks.size() < MailboxLimit) {
+				next.blocks.insert(next.blocks.end(), batch + Batch / 2, batch + Batch);
+				handed_off = true;
+			}
+		}
+
+		if (!handed_off) {
+			for (std::size_t i = Batch / 2; i < Batch; ++i) {
+				arena.release(batch[i]);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mine.mutex);
+			incoming.swap(mine.blocks);
+		}
+
+		for (void *p : incoming) {
+			arena.release(p);
+		}
+		incoming.clear();
+	}
+}
+
+template <class Arena>
+void run(const char *name, const options &opts) {
+	if (!opts.arena.empty() && opts.arena != name) {
+		return;
+	}
+
+	for (std::size_t threads = 1; threads <= opts.max_threads; threads *= 2) {
+		Arena arena;
+		std::vector<mailbox> mailboxes(threads);
+		const std::size_t per_thread = opts.operations / threads;
+
+		auto elapsed = time_code_once<std::chrono::nanoseconds>([&]() {
+			std::vector<std::thread> workers;
+			for (std::size_t t = 0; t < threads; ++t) {
+				workers.emplace_back([&, t]() {
+					worker(arena, mailboxes, t, per_thread);
+				});
+			}
+
+			for (std::thread &thread : workers) {
+				thread.join();
+			}
+		});
+
+		// whatever is still in a mailbox goes back before the arena does
+		for (mailbox &m : mailboxes) {
+			for (void *p : m.blocks) {
+				arena.release(p);
+			}
+		}
+
+		const double operations = static_cast<double>(per_thread * threads);
+		const double ns_per_op  = static_cast<double>(elapsed.count()) / operations;
+
+		std::printf("%s,%zu,%.0f,%.2f,%.2f\n", name, threads, operations, ns_per_op, 1000.0 / ns_per_op);
+		std::fflush(stdout);
+	}
+}
+
+bool parse_options(int argc, char *argv[], options *opts) {
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--max-threads") == 0 && has_value) {
+			opts->max_threads = std::strtoull(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--operations") == 0 && has_value) {
+			opts->operations = std::strtoull(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--arena") == 0 && has_value) {
+			opts->arena = argv[++i];
+		} else {
+			std::fprintf(stderr, "usage: %s [--max-threads N] [--operations N] [--arena NAME]\n", argv[0]);
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+
+	options opts;
+	if (!parse_options(argc, argv, &opts)) {
+		return 1;
+	}
+
+	std::printf("arena,threads,operations,ns_per_operation,million_operations_per_s\n");
+
+	run<mutex_arena>("mutex", opts);
+	run<lockfree_arena>("lockfree", opts);
+	run<magazine_arena>("magazine", opts);
+	run<malloc_arena>("malloc", opts);
+}
@@ -0,0 +1,163 @@
+/*
+ * Compares slab_allocator with malloc/free on mixed size workloads. A
+ * window of live allocations is kept, and every operation frees the oldest
+ * one and allocates a new one in its place, so the allocators see a steady
+ * mix of sizes and lifetimes rather than a stack. For every workload and
+ * allocator it prints one CSV row:
+ *
+ *   workload,allocator,operations,ns_per_operation,million_operations_per_s
+ *
+ * The workloads are:
+ *   small   8 to 128 bytes
+ *   mixed   8 to 4096 bytes, smaller sizes more likely
+ *   large   as mixed, but 1 in 32 requests is 8 to 64 KiB (passed through)
+ *
+ * usage: cpp-utilities-arena-slab-benchmark [--operations N] [--window N]
+ */
+
+#include "cpp-utilities/slab_allocator.h"
+#include "cpp-utilities/time_code.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct options {
+	std::size_t operations = 8 * 1024 * 1024;
+	std::size_t window     = 4096;
+};
+
+class malloc_heap {
+public:
+	void *allocate(std::size_t size) {
+		return std::malloc(size);
+	}
+
+	void deallocate(void *p, std::size_t) {
+		std::free(p);
+	}
+};
+
+class slab_heap {
+public:
+	void *allocate(std::size_t size) {
+		return slabs_.allocate(size);
+	}
+
+	void deallocate(void *p, std::size_t size) {
+		slabs_.deallocate(p, size);
+	}
+
+private:
+	memory::slab_allocator slabs_;
+};
+
+uint64_t next_random(uint64_t &state) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// picks a size class uniformly (so small sizes are more likely), then a size within it
+std::size_t log_uniform(uint64_t &state, unsigned min_shift, unsigned max_shift) {
+	const uint64_t r      = next_random(state);
+	const unsigned shift  = min_shift + static_cast<unsigned>(r % (max_shift - min_shift + 1));
+	const std::size_t top = std::size_t(1) << shift;
+	return top / 2 + 1 + static_cast<std::size_t>((r >> 32) % (top / 2));
+}
+
+// the sizes are generated up front so the timed loop is just the allocator
+std::vector<std::size_t> make_sizes(const char *workload, std::size_t count) {
+	std::vector<std::size_t> sizes(count);
+	uint64_t state = 0x9e3779b97f4a7c15;
+
+	for (std::size_t &size : sizes) {
+		if (std::strcmp(workload, "small") == 0) {
+			size = 8 + next_random(state) % 121;
+		} else if (std::strcmp(workload, "large") == 0 && next_random(state) % 32 == 0) {
+			size = log_uniform(state, 14, 16);
+		} else {
+			size = log_uniform(state, 3, 12);
+		}
+	}
+	return sizes;
+}
+
+template <class Heap>
+void run(const char *workload, const char *name, const std::vector<std::size_t> &sizes, const options &opts) {
+	Heap heap;
+
+	struct allocation {
+		void *p;
+		std::size_t size;
+	};
+
+	std::vector<allocation> live(opts.window, allocation{nullptr, 0});
+
+	auto elapsed = time_code_once<std::chrono::nanoseconds>([&]() {
+		std::size_t slot = 0;
+		for (std::size_t size : sizes) {
+			allocation &a = live[slot];
+			heap.deallocate(a.p, a.size);
+
+			a.p    = heap.allocate(size);
+			a.size = size;
+
+			// touch it, as a real user would
+			*static_cast<volatile char *>(a.p) = 0;
+
+			if (++slot == live.size()) {
+				slot = 0;
+			}
+		}
+	});
+
+	for (const allocation &a : live) {
+		heap.deallocate(a.p, a.size);
+	}
+
+	const double operations = static_cast<double>(sizes.size());
+	const double ns_per_op  = static_cast<double>(elapsed.count()) / operations;
+
+	std::printf("%s,%s,%.0f,%.2f,%.2f\n", workload, name, operations, ns_per_op, 1000.0 / ns_per_op);
+	std::fflush(stdout);
+}
+
+bool parse_options(int argc, char *argv[], options *opts) {
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--operations") == 0 && has_value) {
+			opts->operations = std::strtoull(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--window") == 0 && has_value) {
+			opts->window = std::strtoull(argv[++i], nullptr, 10);
+		} else {
+			std::fprintf(stderr, "usage: %s [--operations N] [--window N]\n", argv[0]);
+			return false;
+		}
+	}
+	return opts->window != 0;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+
+	options opts;
+	if (!parse_options(argc, argv, &opts)) {
+		return 1;
+	}
+
+	std::printf("workload,allocator,operations,ns_per_operation,million_operations_per_s\n");
+
+	for (const char *workload : {"small", "mixed", "large"}) {
+		const std::vector<std::size_t> sizes = make_sizes(workload, opts.operations);
+		run<malloc_heap>(workload, "malloc", sizes, opts);
+		run<slab_heap>(workload, "slab", sizes, opts);
+	}
+}
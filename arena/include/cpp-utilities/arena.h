@@ -25,22 +25,35 @@
 #ifndef UTILITY_ARENA_HPP_
 #define UTILITY_ARENA_HPP_
 
-#include <bitset>
+#include <atomic>
 #include <cassert>
 #include <climits>
-#include <cpp-utilities/bitset.h>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 #define ARENA_ALLOCATOR_PURIFY
 
+// keeps rarely taken slow paths from bloating the inlined fast paths
+#if defined(__GNUC__)
+#define ARENA_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define ARENA_NOINLINE __declspec(noinline)
+#else
+#define ARENA_NOINLINE
+#endif
+
 namespace memory {
 namespace detail {
 
 struct bitset_strategy_tag {};
 struct linked_strategy_tag {};
+struct lockfree_strategy_tag {};
 
 // simplify storage management
 template <class T, size_t Count>
@@ -63,6 +76,7 @@ public:
 
 	malloc_storage &operator=(malloc_storage &&rhs) noexcept {
 		if (this != &rhs) {
+			free(p_);
 			p_ = std::exchange(rhs.p_, nullptr);
 		}
 		return *this;
@@ -72,6 +86,10 @@ public:
 		return p_[index];
 	}
 
+	bool contains(const void *ptr) const noexcept {
+		return ptr >= p_ && ptr < p_ + Count;
+	}
+
 private:
 	T *p_ = nullptr;
 };
@@ -79,11 +97,125 @@ private:
 template <class T, size_t Count, class Strategy>
 class arena_allocator;
 
+inline int count_trailing_zeros(uint64_t word) noexcept {
+	assert(word != 0);
+#if defined(__GNUC__)
+	return __builtin_ctzll(word);
+#else
+	int n = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+/*
+ * A bitmap of Bits bits which can find its first set bit in a handful of
+ * instructions regardless of size. The bits are kept in 64-bit words, and
+ * for more than one word a summary bitmap (built the same way) has one bit
+ * per word marking the words which are non-zero. Each level divides the
+ * size by 64, so 262144 bits need only 3 levels.
+ */
+template <size_t Bits, bool Leaf = (Bits <= 64)>
+class summary_bitmap;
+
+template <size_t Bits>
+class summary_bitmap<Bits, true> {
+public:
+	void set_all() noexcept {
+		word_ = (Bits == 64) ? ~uint64_t(0) : ((uint64_t(1) << Bits) - 1);
+	}
+
+	bool test(size_t index) const noexcept {
+		return (word_ >> index) & 1;
+	}
+
+	void set(size_t index) noexcept {
+		word_ |= uint64_t(1) << index;
+	}
+
+	void reset(size_t index) noexcept {
+		word_ &= ~(uint64_t(1) << index);
+	}
+
+	bool none() const noexcept {
+		return word_ == 0;
+	}
+
+	// returns Bits when no bits are set
+	size_t find_first() const noexcept {
+		return word_ ? count_trailing_zeros(word_) : Bits;
+	}
+
+private:
+	uint64_t word_ = 0;
+};
+
+template <size_t Bits>
+class summary_bitmap<Bits, false> {
+	static constexpr size_t Words = (Bits + 63) / 64;
+
+public:
+	void set_all() noexcept {
+		for (size_t i = 0; i < Words; ++i) {
+			words_[i] = ~uint64_t(0);
+		}
+
+		if (Bits % 64) {
+			words_[Words - 1] = (uint64_t(1) << (Bits % 64)) - 1;
+		}
+
+		summary_.set_all();
+	}
+
+	bool test(size_t index) const noexcept {
+		return (words_[index / 64] >> (index % 64)) & 1;
+	}
+
+	void set(size_t index) noexcept {
+		uint64_t &word = words_[index / 64];
+		if (!word) {
+			summary_.set(index / 64);
+		}
+		word |= uint64_t(1) << (index % 64);
+	}
+
+	void reset(size_t index) noexcept {
+		uint64_t &word = words_[index / 64];
+		word &= ~(uint64_t(1) << (index % 64));
+		if (!word) {
+			summary_.reset(index / 64);
+		}
+	}
+
+	bool none() const noexcept {
+		return summary_.none();
+	}
+
+	// returns Bits when no bits are set
+	size_t find_first() const noexcept {
+		const size_t word = summary_.find_first();
+		if (word == Words) {
+			return Bits;
+		}
+		return word * 64 + count_trailing_zeros(words_[word]);
+	}
+
+private:
+	uint64_t words_[Words] = {};
+	summary_bitmap<Words> summary_;
+};
+
 template <class T, size_t Count>
 class arena_allocator<T, Count, bitset_strategy_tag> {
+public:
+	using value_type = T;
+
 public:
 	arena_allocator() noexcept {
-		freelist_.set();
+		freelist_.set_all();
 	}
 
 	arena_allocator(arena_allocator &&) noexcept            = default;
@@ -98,20 +230,20 @@ public:
 			assert(ptr >= &storage_[0] && "Attempting to release invalid pointer");
 			assert(ptr < &storage_[Count] && "Attempting to release invalid pointer");
 
-			const int index = (reinterpret_cast<T *>(ptr) - &storage_[0]);
+			const size_t index = (reinterpret_cast<T *>(ptr) - &storage_[0]);
 
-			assert(!freelist_[index] && "Double free detected");
-			freelist_.flip(index);
+			assert(!freelist_.test(index) && "Double free detected");
+			freelist_.set(index);
 		}
 	}
 
 	void *allocate() noexcept {
-		const int index = bitset::find_first(freelist_);
+		const size_t index = freelist_.find_first();
 		if (index == Count) {
 			return nullptr;
 		}
 
-		freelist_[index].flip();
+		freelist_.reset(index);
 
 		T *const p = &storage_[index];
 
@@ -123,15 +255,23 @@ public:
 		return p;
 	}
 
+	// true if ptr points into this arena's storage
+	bool owns(const void *ptr) const noexcept {
+		return storage_.contains(ptr);
+	}
+
 private:
 	malloc_storage<T, Count> storage_;
-	std::bitset<Count> freelist_;
+	summary_bitmap<Count> freelist_;
 };
 
 template <class T, size_t Count>
 class arena_allocator<T, Count, linked_strategy_tag> {
 	static_assert(sizeof(T) >= sizeof(void *), "Linked strategy can only be used for objects larger than or equal to the size of a pointer");
 
+public:
+	using value_type = T;
+
 private:
 	struct node {
 		node *next;
@@ -193,10 +333,355 @@ public:
 		return reinterpret_cast<T *>(p);
 	}
 
+	// true if ptr points into this arena's storage
+	bool owns(const void *ptr) const noexcept {
+		return storage_.contains(ptr);
+	}
+
 private:
 	malloc_storage<T, Count> storage_;
 	node *freelist_;
 };
+
+/*
+ * The linked strategy made safe for allocate() and release() to be called
+ * from any number of threads at once, without locks. The freelist links are
+ * block indexes kept beside the storage (so the arena never writes into a
+ * block which some other thread may own by now), and the head packs the
+ * index of the first free block with a generation count that every
+ * successful update bumps. So a head which was popped and pushed back
+ * between our load and our compare-exchange no longer compares equal,
+ * which rules out ABA with only a 64-bit CAS.
+ *
+ * NOTE: moving an arena is not thread safe.
+ */
+template <class T, size_t Count>
+class arena_allocator<T, Count, lockfree_strategy_tag> {
+	static_assert(Count < UINT32_MAX, "Lock-free strategy is limited to 2^32 - 1 blocks");
+
+public:
+	using value_type = T;
+
+private:
+	static constexpr uint32_t Empty = UINT32_MAX;
+
+	static constexpr uint64_t pack(uint32_t index, uint32_t generation) noexcept {
+		return (uint64_t(generation) << 32) | index;
+	}
+
+	static constexpr uint32_t index_of(uint64_t head) noexcept {
+		return static_cast<uint32_t>(head);
+	}
+
+	static constexpr uint32_t generation_of(uint64_t head) noexcept {
+		return static_cast<uint32_t>(head >> 32);
+	}
+
+public:
+	arena_allocator()
+		: next_(new std::atomic<uint32_t>[Count]) {
+		for (size_t i = 0; i < Count; ++i) {
+			next_[i].store((i + 1 < Count) ? static_cast<uint32_t>(i + 1) : Empty, std::memory_order_relaxed);
+		}
+		head_.store(pack(0, 0), std::memory_order_release);
+	}
+
+	~arena_allocator() = default;
+
+public:
+	arena_allocator(arena_allocator &&other) noexcept
+		: storage_(std::move(other.storage_)), next_(std::move(other.next_)), head_(other.head_.exchange(pack(Empty, 0))) {
+	}
+
+	arena_allocator &operator=(arena_allocator &&rhs) noexcept {
+		if (this != &rhs) {
+			storage_ = std::move(rhs.storage_);
+			next_    = std::move(rhs.next_);
+			head_.store(rhs.head_.exchange(pack(Empty, 0)));
+		}
+		return *this;
+	}
+
+private:
+	arena_allocator(const arena_allocator &)            = delete;
+	arena_allocator &operator=(const arena_allocator &) = delete;
+
+public:
+	void release(void *ptr) noexcept {
+		if (ptr) {
+			assert(ptr >= &storage_[0] && "Attempting to release invalid pointer");
+			assert(ptr < &storage_[Count] && "Attempting to release invalid pointer");
+
+			const auto index = static_cast<uint32_t>(reinterpret_cast<T *>(ptr) - &storage_[0]);
+
+			uint64_t head = head_.load(std::memory_order_relaxed);
+			uint64_t desired;
+			do {
+				next_[index].store(index_of(head), std::memory_order_relaxed);
+				desired = pack(index, generation_of(head) + 1);
+			} while (!head_.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed));
+		}
+	}
+
+	void *allocate() noexcept {
+		uint64_t head = head_.load(std::memory_order_acquire);
+		uint64_t desired;
+		do {
+			if (index_of(head) == Empty) {
+				return nullptr;
+			}
+
+			// may be stale if another thread got there first, but then the
+			// generation will have moved on and the exchange fails
+			const uint32_t next = next_[index_of(head)].load(std::memory_order_relaxed);
+			desired             = pack(next, generation_of(head) + 1);
+		} while (!head_.compare_exchange_weak(head, desired, std::memory_order_acquire, std::memory_order_acquire));
+
+		return &storage_[index_of(head)];
+	}
+
+	// true if ptr points into this arena's storage
+	bool owns(const void *ptr) const noexcept {
+		return storage_.contains(ptr);
+	}
+
+private:
+	malloc_storage<T, Count> storage_;
+	std::unique_ptr<std::atomic<uint32_t>[]> next_;
+	std::atomic<uint64_t> head_;
+};
+
+// a single malloc'd run of Count blocks, chained to the previously allocated slabs
+class malloc_slab {
+public:
+	static malloc_slab *create(size_t block_size, size_t count, malloc_slab *next) noexcept {
+		void *const p = malloc(offset() + block_size * count);
+		if (!p) {
+			return nullptr;
+		}
+		return new (p) malloc_slab(block_size * count, count, next);
+	}
+
+	static void destroy(malloc_slab *slab) noexcept {
+		free(slab);
+	}
+
+public:
+	char *data() noexcept {
+		return reinterpret_cast<char *>(this) + offset();
+	}
+
+	bool contains(const void *ptr) const noexcept {
+		const char *const first = reinterpret_cast<const char *>(this) + offset();
+		return ptr >= first && ptr < first + size_;
+	}
+
+	size_t count() const noexcept {
+		return count_;
+	}
+
+	malloc_slab *next() const noexcept {
+		return next_;
+	}
+
+private:
+	malloc_slab(size_t size, size_t count, malloc_slab *next) noexcept
+		: size_(size), count_(count), next_(next) {
+	}
+
+	// the blocks start at the first max_align_t boundary after the header
+	static constexpr size_t offset() noexcept {
+		return (sizeof(malloc_slab) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	}
+
+private:
+	size_t size_;
+	size_t count_;
+	malloc_slab *next_;
+};
+
+/*
+ * Like the linked strategy, but the capacity is chosen at runtime and when
+ * the freelist runs dry another slab, as large as everything allocated so
+ * far, is chained on. So the capacity doubles each time, and blocks already
+ * handed out never move.
+ *
+ * The block size is only needed when growing, so it is a runtime value and
+ * one freelist type serves every block size.
+ */
+class growable_freelist {
+private:
+	struct node {
+		node *next;
+	};
+
+public:
+	// block_size is rounded up to a multiple of (and at least) the size of a pointer
+	growable_freelist(size_t block_size, size_t initial) noexcept
+		: block_size_(block_size > sizeof(node) ? (block_size + alignof(node) - 1) & ~(alignof(node) - 1) : sizeof(node)) {
+		grow(initial ? initial : 1);
+	}
+
+	~growable_freelist() noexcept {
+		while (slabs_) {
+			malloc_slab::destroy(std::exchange(slabs_, slabs_->next()));
+		}
+	}
+
+public:
+	growable_freelist(growable_freelist &&other) noexcept
+		: block_size_(other.block_size_), slabs_(std::exchange(other.slabs_, nullptr)), freelist_(std::exchange(other.freelist_, nullptr)), capacity_(std::exchange(other.capacity_, 0)) {
+	}
+
+	growable_freelist &operator=(growable_freelist &&rhs) noexcept {
+		if (this != &rhs) {
+			growable_freelist(std::move(rhs)).swap(*this);
+		}
+		return *this;
+	}
+
+	void swap(growable_freelist &other) noexcept {
+		std::swap(block_size_, other.block_size_);
+		std::swap(slabs_, other.slabs_);
+		std::swap(freelist_, other.freelist_);
+		std::swap(capacity_, other.capacity_);
+	}
+
+private:
+	growable_freelist(const growable_freelist &)            = delete;
+	growable_freelist &operator=(const growable_freelist &) = delete;
+
+public:
+	void release(void *ptr) noexcept {
+		if (ptr) {
+			assert(owns(ptr) && "Attempting to release invalid pointer");
+			assert((reinterpret_cast<uintptr_t>(ptr) & (alignof(node) - 1)) == 0 && "Attempting to release misaligned pointer");
+
+			node *const p = reinterpret_cast<node *>(ptr);
+			p->next       = std::exchange(freelist_, p);
+		}
+	}
+
+	void *allocate() noexcept {
+		if (!freelist_) {
+			return allocate_slow();
+		}
+
+		node *const p = std::exchange(freelist_, freelist_->next);
+#ifdef ARENA_ALLOCATOR_PURIFY
+		// avoid information disclosure bug
+		p->next = nullptr;
+#endif
+		return p;
+	}
+
+	bool owns(const void *ptr) const noexcept {
+		for (malloc_slab *slab = slabs_; slab; slab = slab->next()) {
+			if (slab->contains(ptr)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// the number of blocks in all slabs so far
+	size_t capacity() const noexcept {
+		return capacity_;
+	}
+
+	size_t block_size() const noexcept {
+		return block_size_;
+	}
+
+private:
+	ARENA_NOINLINE void *allocate_slow() noexcept {
+		// a moved from freelist has no slabs at all
+		if (!grow(capacity_ ? capacity_ : 1)) {
+			return nullptr;
+		}
+		return allocate();
+	}
+
+	bool grow(size_t count) noexcept {
+		malloc_slab *const slab = malloc_slab::create(block_size_, count, slabs_);
+		if (!slab) {
+			return false;
+		}
+
+		slabs_ = slab;
+		capacity_ += count;
+
+		// threaded backwards, so that the slab is handed out in address order
+		char *const data = slab->data();
+		for (size_t i = count; i != 0; --i) {
+			node *const p = reinterpret_cast<node *>(data + (i - 1) * block_size_);
+			p->next       = std::exchange(freelist_, p);
+		}
+		return true;
+	}
+
+private:
+	size_t block_size_;
+	malloc_slab *slabs_ = nullptr;
+	node *freelist_     = nullptr;
+	size_t capacity_    = 0;
+};
+
+// a growable_freelist of blocks for T
+template <class T>
+class growable_arena_allocator {
+	static_assert(alignof(T) <= alignof(std::max_align_t), "Over aligned types are not supported");
+
+public:
+	using value_type = T;
+
+public:
+	explicit growable_arena_allocator(size_t initial) noexcept
+		: freelist_(sizeof(T), initial) {
+	}
+
+	growable_arena_allocator(growable_arena_allocator &&) noexcept            = default;
+	growable_arena_allocator &operator=(growable_arena_allocator &&) noexcept = default;
+	~growable_arena_allocator()                                               = default;
+
+	void swap(growable_arena_allocator &other) noexcept {
+		freelist_.swap(other.freelist_);
+	}
+
+private:
+	growable_arena_allocator(const growable_arena_allocator &)            = delete;
+	growable_arena_allocator &operator=(const growable_arena_allocator &) = delete;
+
+public:
+	void release(void *ptr) noexcept {
+		freelist_.release(ptr);
+	}
+
+	void *allocate() noexcept {
+		return freelist_.allocate();
+	}
+
+	bool owns(const void *ptr) const noexcept {
+		return freelist_.owns(ptr);
+	}
+
+	// the number of blocks in all slabs so far
+	size_t capacity() const noexcept {
+		return freelist_.capacity();
+	}
+
+private:
+	growable_freelist freelist_;
+};
+
+// arenas which grow rather than run out, so a null allocate only ever means
+// the system is out of memory. Anything allocated from them was a block of
+// the arena, which saves an owns() lookup on release
+template <class Arena>
+struct is_growable_arena : std::false_type {};
+
+template <class T>
+struct is_growable_arena<growable_arena_allocator<T>> : std::true_type {};
 }
 
 template <class T, size_t Count>
@@ -209,6 +694,24 @@ detail::arena_allocator<T, Count, detail::bitset_strategy_tag> make_arena(typena
 	return detail::arena_allocator<T, Count, detail::bitset_strategy_tag>();
 }
 
+/**
+ * An arena of Count blocks for T which any number of threads can allocate
+ * from and release to concurrently, without locks
+ */
+template <class T, size_t Count>
+detail::arena_allocator<T, Count, detail::lockfree_strategy_tag> make_lockfree_arena() {
+	return detail::arena_allocator<T, Count, detail::lockfree_strategy_tag>();
+}
+
+/**
+ * An arena with room for initial objects of type T to begin with, which grows
+ * (geometrically) as needed rather than running out, see growable_arena_allocator
+ */
+template <class T>
+detail::growable_arena_allocator<T> make_growable_arena(size_t initial) {
+	return detail::growable_arena_allocator<T>(initial);
+}
+
 }
 
 #endif
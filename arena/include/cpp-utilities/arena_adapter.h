@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ARENA_ADAPTER_20261017_H_
+#define ARENA_ADAPTER_20261017_H_
+
+#include <cpp-utilities/arena.h>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define ARENA_HAS_MEMORY_RESOURCE
+#endif
+#endif
+
+namespace memory {
+
+/**
+ * A standard allocator which takes single objects from an arena (any of the
+ * arenas in arena.h or concurrent_arena.h), so node based containers can get
+ * their nodes from it instead of the global heap:
+ *
+ *   auto arena = memory::make_growable_arena<node_block>(1024);
+ *   std::list<int, memory::arena_allocator_adapter<int, decltype(arena)>> list(arena);
+ *
+ * Containers rebind the allocator to their node type, so the arena's blocks
+ * need to be at least as large and as aligned as a node. Anything which
+ * doesn't fit in a block, array allocations (e.g. a vector's storage or a
+ * hash table's buckets) and requests made while a fixed size arena is full
+ * fall back to std::allocator. Arenas which grow never fall back for a
+ * single node, they throw std::bad_alloc if they can't grow, so releasing
+ * a node to them needs no owns() lookup.
+ *
+ * The adapter only refers to the arena, which must outlive every container
+ * using it. Two adapters compare equal when they use the same arena. Like
+ * the arena itself, it is only thread safe if the arena is.
+ */
+template <class T, class Arena>
+class arena_allocator_adapter {
+	template <class U, class A>
+	friend class arena_allocator_adapter;
+
+	using block_type = typename Arena::value_type;
+
+	static constexpr bool FitsBlock = sizeof(T) <= sizeof(block_type) && alignof(T) <= alignof(block_type);
+	static constexpr bool Growable  = detail::is_growable_arena<Arena>::value;
+
+public:
+	using value_type                             = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap            = std::true_type;
+
+	template <class U>
+	struct rebind {
+		using other = arena_allocator_adapter<U, Arena>;
+	};
+
+public:
+	arena_allocator_adapter(Arena &arena) noexcept
+		: arena_(&arena) {
+	}
+
+	template <class U>
+	arena_allocator_adapter(const arena_allocator_adapter<U, Arena> &other) noexcept
+		: arena_(other.arena_) {
+	}
+
+public:
+	T *allocate(std::size_t n) {
+		if (FitsBlock && n == 1) {
+			if (void *const p = arena_->allocate()) {
+				return static_cast<T *>(p);
+			}
+
+			if (Growable) {
+				throw std::bad_alloc();
+			}
+		}
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T *p, std::size_t n) noexcept {
+		if (FitsBlock && n == 1 && (Growable || arena_->owns(p))) {
+			arena_->release(p);
+			return;
+		}
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	Arena &arena() const noexcept {
+		return *arena_;
+	}
+
+public:
+	template <class U>
+	bool operator==(const arena_allocator_adapter<U, Arena> &rhs) const noexcept {
+		return arena_ == rhs.arena_;
+	}
+
+	template <class U>
+	bool operator!=(const arena_allocator_adapter<U, Arena> &rhs) const noexcept {
+		return arena_ != rhs.arena_;
+	}
+
+private:
+	Arena *arena_;
+};
+
+#ifdef ARENA_HAS_MEMORY_RESOURCE
+/**
+ * A std::pmr::memory_resource which serves any request that fits in one of
+ * the arena's blocks from the arena, and everything else (or anything which
+ * doesn't fit while a fixed size arena is full) from the upstream resource.
+ * As with arena_allocator_adapter, arenas which grow throw std::bad_alloc
+ * rather than fall back, so releasing to them needs no owns() lookup.
+ *
+ *   auto arena = memory::make_arena<node_block, 4096>();
+ *   memory::arena_memory_resource<decltype(arena)> resource(arena);
+ *   std::pmr::map<int, int> map(&resource);
+ */
+template <class Arena>
+class arena_memory_resource : public std::pmr::memory_resource {
+	using block_type = typename Arena::value_type;
+
+	static constexpr bool Growable = detail::is_growable_arena<Arena>::value;
+
+public:
+	explicit arena_memory_resource(Arena &arena, std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept
+		: arena_(&arena), upstream_(upstream) {
+	}
+
+	arena_memory_resource(const arena_memory_resource &)            = delete;
+	arena_memory_resource &operator=(const arena_memory_resource &) = delete;
+
+public:
+	Arena &arena() const noexcept {
+		return *arena_;
+	}
+
+	std::pmr::memory_resource *upstream_resource() const noexcept {
+		return upstream_;
+	}
+
+private:
+	static bool fits_block(std::size_t bytes, std::size_t alignment) noexcept {
+		return bytes <= sizeof(block_type) && alignment <= alignof(block_type);
+	}
+
+	void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+		if (fits_block(bytes, alignment)) {
+			if (void *const p = arena_->allocate()) {
+				return p;
+			}
+
+			if (Growable) {
+				throw std::bad_alloc();
+			}
+		}
+		return upstream_->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+		if (fits_block(bytes, alignment) && (Growable || arena_->owns(p))) {
+			arena_->release(p);
+			return;
+		}
+		upstream_->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+
+private:
+	Arena *arena_;
+	std::pmr::memory_resource *upstream_;
+};
+#endif
+
+}
+
+#endif
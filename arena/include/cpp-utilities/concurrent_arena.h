@@ -0,0 +1,339 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONCURRENT_ARENA_20261017_H_
+#define CONCURRENT_ARENA_20261017_H_
+
+#include <cpp-utilities/arena.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace memory {
+namespace detail {
+
+/*
+ * A thread safe arena in the style of Bonwick's magazine allocator. Each
+ * thread keeps two magazines (small stacks of free blocks) for every arena
+ * it uses, and allocate/release only ever push and pop those, so the common
+ * path takes no locks and touches nothing shared with other threads.
+ *
+ * Only when both of a thread's magazines are empty (or full) does it visit
+ * the shared depot, under a mutex, to swap a whole magazine for a full (or
+ * empty) one. The depot refills magazines from a growable_arena_allocator
+ * when it has no full ones left, so the arena as a whole never runs out.
+ *
+ * Blocks may be released by a different thread to the one which allocated
+ * them.
+ *
+ * NOTE: a thread's magazines hold a reference to the depot, which owns the
+ * memory. Destroying the arena flushes the destroying thread's magazines,
+ * but blocks cached by other threads (and the slabs they came from) are
+ * only freed once those threads exit, call flush(), or next use a
+ * concurrent arena whose cache they don't have yet.
+ */
+template <class T, size_t MagazineSize = 64>
+class concurrent_arena_allocator {
+public:
+	using value_type = T;
+
+private:
+	struct magazine {
+		size_t count = 0;
+		void *rounds[MagazineSize];
+	};
+
+	struct depot {
+		explicit depot(size_t initial)
+			: backing(initial) {
+		}
+
+		~depot() {
+			for (magazine *m : full) {
+				delete m;
+			}
+
+			for (magazine *m : empty) {
+				delete m;
+			}
+		}
+
+		// a full magazine, made from fresh blocks if there are none waiting
+		magazine *take_full() {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!full.empty()) {
+				magazine *const m = full.back();
+				full.pop_back();
+				return m;
+			}
+
+			magazine *m = take_empty_locked();
+			while (m->count < MagazineSize) {
+				void *const p = backing.allocate();
+				if (!p) {
+					break;
+				}
+				m->rounds[m->count++] = p;
+			}
+			return m;
+		}
+
+		magazine *take_empty() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return take_empty_locked();
+		}
+
+		magazine *take_empty_locked() {
+			if (!empty.empty()) {
+				magazine *const m = empty.back();
+				empty.pop_back();
+				return m;
+			}
+			return new magazine;
+		}
+
+		void give(magazine *m) {
+			if (m) {
+				std::lock_guard<std::mutex> lock(mutex);
+				(m->count != 0 ? full : empty).push_back(m);
+			}
+		}
+
+		std::mutex mutex;
+		growable_arena_allocator<T> backing;
+		std::vector<magazine *> full;
+		std::vector<magazine *> empty;
+	};
+
+	// one per thread per arena
+	struct thread_cache {
+		explicit thread_cache(std::shared_ptr<depot> d)
+			: owner(std::move(d)) {
+		}
+
+		~thread_cache() {
+			owner->give(loaded);
+			owner->give(previous);
+		}
+
+		thread_cache(const thread_cache &)            = delete;
+		thread_cache &operator=(const thread_cache &) = delete;
+
+		std::shared_ptr<depot> owner;
+		magazine *loaded   = nullptr;
+		magazine *previous = nullptr;
+	};
+
+	using cache_list = std::vector<std::unique_ptr<thread_cache>>;
+
+public:
+	explicit concurrent_arena_allocator(size_t initial)
+		: depot_(std::make_shared<depot>(initial)) {
+	}
+
+	concurrent_arena_allocator(concurrent_arena_allocator &&other) noexcept = default;
+
+	concurrent_arena_allocator &operator=(concurrent_arena_allocator &&rhs) noexcept {
+		if (this != &rhs) {
+			if (depot_) {
+				flush();
+			}
+			depot_ = std::move(rhs.depot_);
+		}
+		return *this;
+	}
+
+	~concurrent_arena_allocator() {
+		// the other threads' caches for this arena are dropped the next time
+		// they look one up, see find_cache
+		if (depot_) {
+			flush();
+		}
+	}
+
+private:
+	concurrent_arena_allocator(const concurrent_arena_allocator &)            = delete;
+	concurrent_arena_allocator &operator=(const concurrent_arena_allocator &) = delete;
+
+public:
+	void *allocate() {
+		thread_cache *const c = cache();
+		magazine *const m     = c->loaded;
+		if (m->count != 0) {
+			return m->rounds[--m->count];
+		}
+		return allocate_slow(c);
+	}
+
+	void release(void *ptr) {
+		if (ptr) {
+			thread_cache *const c = cache();
+			magazine *const m     = c->loaded;
+			if (m->count != MagazineSize) {
+				m->rounds[m->count++] = ptr;
+				return;
+			}
+			release_slow(c, ptr);
+		}
+	}
+
+	// hands this thread's cached blocks for this arena back to the depot
+	void flush() {
+		cache_list &caches = thread_caches();
+		for (auto it = caches.begin(); it != caches.end(); ++it) {
+			if ((*it)->owner == depot_) {
+				if (last_cache() == it->get()) {
+					last_cache() = nullptr;
+				}
+				caches.erase(it);
+				return;
+			}
+		}
+	}
+
+	bool owns(const void *ptr) const {
+		std::lock_guard<std::mutex> lock(depot_->mutex);
+		return depot_->backing.owns(ptr);
+	}
+
+	size_t capacity() const {
+		std::lock_guard<std::mutex> lock(depot_->mutex);
+		return depot_->backing.capacity();
+	}
+
+	// the number of arenas (including destroyed ones not yet dropped) the
+	// calling thread holds magazines for
+	static size_t thread_cache_count() {
+		return thread_caches().size();
+	}
+
+private:
+	// the most recently used cache is checked first, without touching the
+	// (non trivial, so lazily constructed) thread_local list
+	static thread_cache *&last_cache() noexcept {
+		static thread_local thread_cache *last = nullptr;
+		return last;
+	}
+
+	static cache_list &thread_caches() {
+		static thread_local cache_list caches;
+		return caches;
+	}
+
+	thread_cache *cache() {
+		thread_cache *const last = last_cache();
+		if (last && last->owner == depot_) {
+			return last;
+		}
+		return find_cache();
+	}
+
+	ARENA_NOINLINE thread_cache *find_cache() {
+		cache_list &caches = thread_caches();
+
+		// a cache which holds the only reference to its depot belongs to an
+		// arena which has been destroyed, dropping it frees the depot
+		for (auto it = caches.begin(); it != caches.end();) {
+			if ((*it)->owner.use_count() == 1) {
+				if (last_cache() == it->get()) {
+					last_cache() = nullptr;
+				}
+				it = caches.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		thread_cache *c = nullptr;
+		for (const auto &cache : caches) {
+			if (cache->owner == depot_) {
+				c = cache.get();
+				break;
+			}
+		}
+
+		if (!c) {
+			caches.push_back(std::make_unique<thread_cache>(depot_));
+			c           = caches.back().get();
+			c->loaded   = depot_->take_empty();
+			c->previous = depot_->take_empty();
+		}
+
+		last_cache() = c;
+		return c;
+	}
+
+	ARENA_NOINLINE void *allocate_slow(thread_cache *c) {
+		// loaded is empty, so try the previous magazine, and failing that swap
+		// the empty one for a full one from the depot
+		if (c->previous->count == 0) {
+			magazine *const full = depot_->take_full();
+			if (full->count == 0) {
+				depot_->give(full);
+				return nullptr;
+			}
+
+			depot_->give(c->previous);
+			c->previous = full;
+		}
+
+		std::swap(c->loaded, c->previous);
+		return c->loaded->rounds[--c->loaded->count];
+	}
+
+	ARENA_NOINLINE void release_slow(thread_cache *c, void *ptr) {
+		// loaded is full, so try the previous magazine, and failing that swap
+		// the full one for an empty one from the depot
+		if (c->previous->count == MagazineSize) {
+			depot_->give(c->previous);
+			c->previous = depot_->take_empty();
+		}
+
+		std::swap(c->loaded, c->previous);
+		c->loaded->rounds[c->loaded->count++] = ptr;
+	}
+
+private:
+	std::shared_ptr<depot> depot_;
+};
+
+template <class T, size_t MagazineSize>
+struct is_growable_arena<concurrent_arena_allocator<T, MagazineSize>> : std::true_type {};
+
+}
+
+/**
+ * A thread safe arena of blocks for T, starting with room for initial of
+ * them and growing as needed, see concurrent_arena_allocator
+ */
+template <class T>
+detail::concurrent_arena_allocator<T> make_concurrent_arena(size_t initial) {
+	return detail::concurrent_arena_allocator<T>(initial);
+}
+
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MONOTONIC_ARENA_20261017_H_
+#define MONOTONIC_ARENA_20261017_H_
+
+#include <cpp-utilities/arena.h>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+namespace memory {
+
+/*
+ * A bump allocator for variable sized, short lived data which is all freed
+ * together (e.g. per request scratch space). allocate() just rounds a
+ * pointer up to the requested alignment and moves it along, and there is
+ * no per allocation release. Instead everything allocated since a mark()
+ * is freed at once with rewind(), or everything with reset().
+ *
+ * Memory comes from a chain of malloc'd chunks, each twice as large as the
+ * one before. Chunks are never freed before the arena is, so after a
+ * rewind or reset the same memory is handed out again without going back
+ * to malloc.
+ *
+ * NOTE: nothing is constructed or destroyed, destructors of objects placed
+ * in the arena are not run by rewind(), reset() or the arena's destructor.
+ */
+class monotonic_arena {
+private:
+	struct chunk {
+		chunk *next;
+		size_t size;
+
+		char *data() noexcept {
+			return reinterpret_cast<char *>(this) + offset();
+		}
+
+		char *end() noexcept {
+			return data() + size;
+		}
+
+		// the data starts at the first max_align_t boundary after the header
+		static constexpr size_t offset() noexcept {
+			return (sizeof(chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+		}
+	};
+
+public:
+	// a position in the arena, see mark() and rewind()
+	struct marker {
+		chunk *owner;
+		char *position;
+	};
+
+	// rewinds the arena to where it was when the scope was created
+	class scope {
+	public:
+		explicit scope(monotonic_arena &arena) noexcept
+			: arena_(arena), marker_(arena.mark()) {
+		}
+
+		~scope() noexcept {
+			arena_.rewind(marker_);
+		}
+
+		scope(const scope &)            = delete;
+		scope &operator=(const scope &) = delete;
+
+	private:
+		monotonic_arena &arena_;
+		marker marker_;
+	};
+
+public:
+	explicit monotonic_arena(size_t initial = 4096) noexcept
+		: next_size_(initial ? initial : 1) {
+		add_chunk(next_size_);
+	}
+
+	~monotonic_arena() noexcept {
+		while (first_) {
+			free(std::exchange(first_, first_->next));
+		}
+	}
+
+public:
+	monotonic_arena(monotonic_arena &&other) noexcept
+		: first_(std::exchange(other.first_, nullptr)), current_(std::exchange(other.current_, nullptr)), position_(std::exchange(other.position_, nullptr)), end_(std::exchange(other.end_, nullptr)), next_size_(other.next_size_), capacity_(std::exchange(other.capacity_, 0)) {
+	}
+
+	monotonic_arena &operator=(monotonic_arena &&rhs) noexcept {
+		if (this != &rhs) {
+			monotonic_arena(std::move(rhs)).swap(*this);
+		}
+		return *this;
+	}
+
+	void swap(monotonic_arena &other) noexcept {
+		std::swap(first_, other.first_);
+		std::swap(current_, other.current_);
+		std::swap(position_, other.position_);
+		std::swap(end_, other.end_);
+		std::swap(next_size_, other.next_size_);
+		std::swap(capacity_, other.capacity_);
+	}
+
+private:
+	monotonic_arena(const monotonic_arena &)            = delete;
+	monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+public:
+	/**
+	 * returns size bytes aligned to alignment (which must be a power of
+	 * two), or nullptr if more memory was needed and malloc failed
+	 */
+	void *allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+		if (void *const p = try_allocate(size, alignment)) {
+			return p;
+		}
+		return allocate_slow(size, alignment);
+	}
+
+	// room for count objects of type T, uninitialized
+	template <class T>
+	T *allocate_array(size_t count) noexcept {
+		if (count > SIZE_MAX / sizeof(T)) {
+			return nullptr;
+		}
+		return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	marker mark() const noexcept {
+		return marker{current_, position_};
+	}
+
+	// frees everything allocated since m was taken, which must be a mark of
+	// this arena that hasn't itself been rewound past
+	void rewind(const marker &m) noexcept {
+		if (!m.owner) {
+			reset();
+			return;
+		}
+
+		assert(m.position >= m.owner->data() && m.position <= m.owner->end() && "Invalid marker");
+		current_  = m.owner;
+		position_ = m.position;
+		end_      = m.owner->end();
+	}
+
+	// frees everything, but keeps the chunks for reuse
+	void reset() noexcept {
+		enter(first_);
+	}
+
+	// the total size of all chunks so far
+	size_t capacity() const noexcept {
+		return capacity_;
+	}
+
+private:
+	void enter(chunk *c) noexcept {
+		current_  = c;
+		position_ = c ? c->data() : nullptr;
+		end_      = c ? c->end() : nullptr;
+	}
+
+	bool add_chunk(size_t size) noexcept {
+		chunk *const c = static_cast<chunk *>(malloc(chunk::offset() + size));
+		if (!c) {
+			return false;
+		}
+
+		c->next = nullptr;
+		c->size = size;
+
+		// the chain stays in allocation order, so chunks after the current
+		// one are the ones a rewind or reset left for reuse
+		if (!first_) {
+			first_ = c;
+		} else {
+			chunk *last = current_;
+			while (last->next) {
+				last = last->next;
+			}
+			last->next = c;
+		}
+
+		capacity_ += size;
+		enter(c);
+		return true;
+	}
+
+	ARENA_NOINLINE void *allocate_slow(size_t size, size_t alignment) noexcept {
+		// first try the chunks we've already got
+		for (chunk *c = current_ ? current_->next : first_; c; c = c->next) {
+			enter(c);
+			if (void *const p = try_allocate(size, alignment)) {
+				return p;
+			}
+		}
+
+		if (size > SIZE_MAX / 2 - alignment) {
+			return nullptr;
+		}
+
+		while (next_size_ < size + alignment) {
+			next_size_ *= 2;
+		}
+
+		if (!add_chunk(next_size_)) {
+			return nullptr;
+		}
+		next_size_ *= 2;
+
+		return try_allocate(size, alignment);
+	}
+
+	// nullptr if it doesn't fit in the current chunk (or there isn't one)
+	void *try_allocate(size_t size, size_t alignment) noexcept {
+		const uintptr_t p   = (reinterpret_cast<uintptr_t>(position_) + alignment - 1) & ~(alignment - 1);
+		const uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+		if (p <= end && size <= end - p) {
+			position_ = reinterpret_cast<char *>(p + size);
+			return reinterpret_cast<void *>(p);
+		}
+		return nullptr;
+	}
+
+private:
+	chunk *first_     = nullptr;
+	chunk *current_   = nullptr;
+	char *position_   = nullptr;
+	char *end_        = nullptr;
+	size_t next_size_ = 0;
+	size_t capacity_  = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLAB_ALLOCATOR_20261017_H_
+#define SLAB_ALLOCATOR_20261017_H_
+
+#include <array>
+#include <cpp-utilities/arena.h>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+namespace memory {
+namespace detail {
+
+// malloc for alignments beyond max_align_t, the original pointer is kept just before the block
+inline void *aligned_malloc(size_t size, size_t alignment) noexcept {
+	if (size > SIZE_MAX - alignment - sizeof(void *)) {
+		return nullptr;
+	}
+
+	void *const raw = malloc(size + alignment + sizeof(void *));
+	if (!raw) {
+		return nullptr;
+	}
+
+	const uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + sizeof(void *) + alignment - 1) & ~(alignment - 1);
+	reinterpret_cast<void **>(p)[-1] = raw;
+	return reinterpret_cast<void *>(p);
+}
+
+inline void aligned_free(void *ptr) noexcept {
+	if (ptr) {
+		free(static_cast<void **>(ptr)[-1]);
+	}
+}
+
+}
+
+/*
+ * A general purpose small object allocator, built from a growable freelist
+ * (the core of the growable arena) per size class: 8, 16, 32, ... 4096
+ * bytes. A request is served by the smallest class which fits it, so
+ * allocate and deallocate are a class lookup plus a freelist pop/push, with
+ * no branching on the class. Each class grows by chaining on slabs as
+ * needed.
+ *
+ * Requests larger than the largest class, or aligned beyond
+ * alignof(std::max_align_t), pass through to malloc.
+ *
+ * Every block is aligned to the smaller of its class size and
+ * alignof(std::max_align_t), which suits any object that fits in it, so the
+ * alignment only needs to be given for over aligned requests. deallocate
+ * must be passed the same size (and alignment, if one was given) as the
+ * allocate call.
+ *
+ * NOTE: like the arenas it is built on, it is not thread safe, use one per
+ * thread.
+ */
+class slab_allocator {
+public:
+	static constexpr size_t MinSize    = 8;
+	static constexpr size_t MaxSize    = 4096;
+	static constexpr size_t ClassCount = 10;
+
+	// the first slab of each class is about this large
+	static constexpr size_t InitialSlabSize = 16384;
+
+public:
+	slab_allocator() noexcept
+		: classes_(make_classes(std::make_index_sequence<ClassCount>())) {
+	}
+
+	slab_allocator(slab_allocator &&) noexcept            = default;
+	slab_allocator &operator=(slab_allocator &&) noexcept = default;
+	~slab_allocator()                                     = default;
+
+private:
+	slab_allocator(const slab_allocator &)            = delete;
+	slab_allocator &operator=(const slab_allocator &) = delete;
+
+public:
+	void *allocate(size_t size) noexcept {
+		if (size > MaxSize) {
+			return malloc(size);
+		}
+		return classes_[class_index(size)].allocate();
+	}
+
+	void *allocate(size_t size, size_t alignment) noexcept {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+		if (alignment > alignof(std::max_align_t)) {
+			return detail::aligned_malloc(size, alignment);
+		}
+		return allocate(size > alignment ? size : alignment);
+	}
+
+	void deallocate(void *ptr, size_t size) noexcept {
+		if (size > MaxSize) {
+			free(ptr);
+			return;
+		}
+		classes_[class_index(size)].release(ptr);
+	}
+
+	void deallocate(void *ptr, size_t size, size_t alignment) noexcept {
+		if (alignment > alignof(std::max_align_t)) {
+			detail::aligned_free(ptr);
+			return;
+		}
+		deallocate(ptr, size > alignment ? size : alignment);
+	}
+
+	// the block size a request is served from, 0 if it passes through to malloc
+	static size_t size_class(size_t size, size_t alignment = 1) noexcept {
+		if (size < alignment) {
+			size = alignment;
+		}
+
+		if (size > MaxSize || alignment > alignof(std::max_align_t)) {
+			return 0;
+		}
+		return MinSize << class_index(size);
+	}
+
+	// true if ptr is a block from one of the size classes
+	bool owns(const void *ptr) const noexcept {
+		for (const detail::growable_freelist &c : classes_) {
+			if (c.owns(ptr)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	template <size_t... I>
+	static std::array<detail::growable_freelist, ClassCount> make_classes(std::index_sequence<I...>) noexcept {
+		return {{detail::growable_freelist(MinSize << I, InitialSlabSize / (MinSize << I))...}};
+	}
+
+	// 0 for 0..8 bytes, 1 for 9..16, 2 for 17..32, ...
+	static size_t class_index(size_t size) noexcept {
+		const size_t n = (size ? size - 1 : 0) | (MinSize - 1);
+#if defined(__GNUC__)
+		// the bit length of n, less that of MinSize - 1 (which is 3)
+		return (sizeof(unsigned long) * CHAR_BIT) - __builtin_clzl(static_cast<unsigned long>(n)) - 3;
+#else
+		size_t index = 0;
+		for (size_t m = n >> 3; m != 0; m >>= 1) {
+			++index;
+		}
+		return index;
+#endif
+	}
+
+private:
+	std::array<detail::growable_freelist, ClassCount> classes_;
+};
+
+}
+
+#endif
@@ -1,5 +1,21 @@
 #include <cpp-utilities/arena.h>
+#include <cpp-utilities/arena_adapter.h>
+#include <cpp-utilities/concurrent_arena.h>
+#include <cpp-utilities/monotonic_arena.h>
+#include <cpp-utilities/slab_allocator.h>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <stdint.h>
+#include <thread>
+#include <vector>
 
 int main() {
 
@@ -15,4 +31,449 @@ int main() {
 	
 	arena.release(x1);
 	arena.release(x2);
+
+	// growable arenas keep going past their initial capacity, without moving anything
+	{
+		struct order {
+			uint64_t id;
+			double price;
+			uint32_t quantity;
+		};
+
+		auto growable = memory::make_growable_arena<order>(4);
+		assert(growable.capacity() == 4);
+
+		std::vector<order *> orders;
+		for (uint32_t i = 0; i < 100; ++i) {
+			auto p = static_cast<order *>(growable.allocate());
+			assert(p);
+			assert(reinterpret_cast<uintptr_t>(p) % alignof(order) == 0);
+			assert(growable.owns(p));
+			*p = order{i, i * 1.5, i};
+			orders.push_back(p);
+		}
+
+		assert(growable.capacity() == 128);
+		assert(std::set<order *>(orders.begin(), orders.end()).size() == orders.size());
+
+		for (uint32_t i = 0; i < 100; ++i) {
+			assert(orders[i]->id == i && orders[i]->quantity == i);
+		}
+
+		// released blocks are reused before the arena grows again
+		for (order *p : orders) {
+			growable.release(p);
+		}
+
+		for (int i = 0; i < 128; ++i) {
+			growable.allocate();
+		}
+		assert(growable.capacity() == 128);
+
+		int local;
+		assert(!growable.owns(&local));
+
+		// smaller than a pointer still works, each block is just rounded up
+		auto bytes = memory::make_growable_arena<uint8_t>(0);
+		auto b1    = static_cast<uint8_t *>(bytes.allocate());
+		auto b2    = static_cast<uint8_t *>(bytes.allocate());
+		assert(b1 && b2 && b1 != b2);
+		bytes.release(b1);
+		bytes.release(b2);
+
+		auto moved = std::move(bytes);
+		assert(moved.capacity() == 2 && bytes.capacity() == 0);
+
+		// a moved from arena starts over
+		auto b3 = bytes.allocate();
+		assert(b3 && bytes.capacity() == 1);
+		bytes.release(b3);
+	}
+
+	// concurrent arenas can be shared by many threads, and a block can be
+	// released by a different thread to the one which allocated it
+	{
+		struct block {
+			uint64_t owner;
+			uint64_t serial;
+		};
+
+		auto shared = memory::make_concurrent_arena<block>(16);
+
+		std::mutex mutex;
+		std::vector<block *> handoff;
+		std::vector<std::thread> threads;
+
+		for (uint64_t t = 0; t < 4; ++t) {
+			threads.emplace_back([&, t]() {
+				std::vector<block *> mine;
+				for (int round = 0; round < 50; ++round) {
+					for (uint64_t i = 0; i < 500; ++i) {
+						auto p = static_cast<block *>(shared.allocate());
+						assert(p);
+						*p = block{t, i};
+						mine.push_back(p);
+					}
+
+					// nobody else was handed any of these
+					for (uint64_t i = 0; i < mine.size(); ++i) {
+						assert(mine[i]->owner == t && mine[i]->serial == i);
+					}
+
+					std::lock_guard<std::mutex> lock(mutex);
+					for (size_t i = 0; i < mine.size(); i += 2) {
+						handoff.push_back(mine[i]);
+					}
+					for (size_t i = 1; i < mine.size(); i += 2) {
+						shared.release(mine[i]);
+					}
+					mine.clear();
+
+					while (!handoff.empty() && handoff.size() % 3 != 0) {
+						shared.release(handoff.back());
+						handoff.pop_back();
+					}
+				}
+
+				shared.flush();
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		for (block *p : handoff) {
+			assert(shared.owns(p));
+			shared.release(p);
+		}
+
+		int local;
+		assert(!shared.owns(&local));
+	}
+
+	// destroying a concurrent arena frees its memory, rather than leaving it
+	// cached by the threads which used it
+	{
+		using arena_type = decltype(memory::make_concurrent_arena<uint64_t>(0));
+
+		for (int i = 0; i < 5000; ++i) {
+			auto scratch = memory::make_concurrent_arena<uint64_t>(1024);
+			auto p       = scratch.allocate();
+			assert(p);
+			scratch.release(p);
+		}
+		assert(arena_type::thread_cache_count() == 0);
+
+		// another thread's cache for a destroyed arena is dropped when it next
+		// looks up a cache
+		std::unique_ptr<arena_type> first(new arena_type(16));
+		std::atomic<int> step(0);
+
+		std::thread worker([&]() {
+			first->release(first->allocate());
+			assert(arena_type::thread_cache_count() == 1);
+			step = 1;
+			while (step != 2) {
+				std::this_thread::yield();
+			}
+
+			auto second = memory::make_concurrent_arena<uint64_t>(16);
+			second.release(second.allocate());
+			assert(arena_type::thread_cache_count() == 1);
+		});
+
+		while (step != 1) {
+			std::this_thread::yield();
+		}
+		first.reset();
+		step = 2;
+		worker.join();
+	}
+
+	// lock-free arenas, blocks allocated by producers are released by consumers
+	{
+		struct message {
+			uint64_t producer;
+			uint64_t sequence;
+		};
+
+		auto lockfree = memory::make_lockfree_arena<message, 1024>();
+
+		std::mutex mutex;
+		std::vector<message *> queue;
+		std::vector<std::thread> threads;
+
+		for (uint64_t t = 0; t < 2; ++t) {
+			threads.emplace_back([&, t]() {
+				for (uint64_t i = 0; i < 20000;) {
+					auto p = static_cast<message *>(lockfree.allocate());
+					if (!p) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					*p = message{t, i++};
+					std::lock_guard<std::mutex> lock(mutex);
+					queue.push_back(p);
+				}
+			});
+		}
+
+		for (int t = 0; t < 2; ++t) {
+			threads.emplace_back([&]() {
+				for (int released = 0; released < 20000;) {
+					message *p = nullptr;
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if (!queue.empty()) {
+							p = queue.back();
+							queue.pop_back();
+						}
+					}
+
+					if (!p) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					assert(p->producer < 2 && p->sequence < 20000);
+					lockfree.release(p);
+					++released;
+				}
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		// everything came back, so the whole arena can be handed out again
+		std::set<message *> all;
+		while (auto p = static_cast<message *>(lockfree.allocate())) {
+			all.insert(p);
+		}
+		assert(all.size() == 1024);
+	}
+
+	// large bitset arenas find free blocks through the summary levels, always
+	// handing out the lowest free block
+	{
+		constexpr size_t Count = 40000;
+		auto small             = memory::make_arena<uint16_t, Count>();
+
+		std::vector<uint16_t *> blocks;
+		for (size_t i = 0; i < Count; ++i) {
+			auto p = static_cast<uint16_t *>(small.allocate());
+			assert(p);
+			blocks.push_back(p);
+		}
+		assert(!small.allocate());
+
+		for (size_t i = 1; i < Count; ++i) {
+			assert(blocks[i] == blocks[0] + i);
+		}
+
+		const size_t freed[] = {39999, 20000, 4095, 4096, 63, 64};
+		for (size_t index : freed) {
+			small.release(blocks[index]);
+		}
+
+		const size_t expected[] = {63, 64, 4095, 4096, 20000, 39999};
+		for (size_t index : expected) {
+			assert(small.allocate() == blocks[index]);
+		}
+		assert(!small.allocate());
+	}
+
+	// standard containers can take their nodes from an arena, falling back
+	// to the heap once a fixed size arena is full
+	{
+		struct alignas(std::max_align_t) node_block {
+			unsigned char bytes[64];
+		};
+
+		auto blocks     = memory::make_arena<node_block, 100>();
+		using allocator = memory::arena_allocator_adapter<int, decltype(blocks)>;
+
+		std::list<int, allocator> list{allocator(blocks)};
+		for (int i = 0; i < 150; ++i) {
+			list.push_back(i);
+		}
+
+		int pooled = 0;
+		for (const int &value : list) {
+			pooled += blocks.owns(&value);
+		}
+		assert(pooled == 100);
+
+		list.clear();
+		list.push_back(1);
+		assert(blocks.owns(&list.back()));
+
+		std::map<int, int, std::less<int>, memory::arena_allocator_adapter<std::pair<const int, int>, decltype(blocks)>> map(blocks);
+		map[1] = 2;
+		map[2] = 4;
+		assert(blocks.owns(&map.at(1)) && blocks.owns(&map.at(2)));
+		assert(map.get_allocator() == list.get_allocator());
+
+		// the heap fallback is std::allocator, so it honours over alignment (from
+		// C++17) and rejects impossible sizes
+		struct alignas(64) wide {
+			unsigned char bytes[64];
+		};
+
+		memory::arena_allocator_adapter<wide, decltype(blocks)> wide_allocator(blocks);
+		wide *w = wide_allocator.allocate(3);
+		assert(!blocks.owns(w));
+#ifdef __cpp_aligned_new
+		assert(reinterpret_cast<uintptr_t>(w) % 64 == 0);
+#endif
+		wide_allocator.deallocate(w, 3);
+
+		bool threw = false;
+		try {
+			wide_allocator.allocate(SIZE_MAX / 2);
+		} catch (const std::bad_alloc &) {
+			threw = true;
+		}
+		assert(threw);
+
+		// growing arenas, released nodes go straight back without an owns() lookup
+		auto concurrent = memory::make_concurrent_arena<node_block>(8);
+		std::list<int, memory::arena_allocator_adapter<int, decltype(concurrent)>> shared_list{concurrent};
+		for (int i = 0; i < 100; ++i) {
+			shared_list.push_back(i);
+		}
+		assert(concurrent.owns(&shared_list.front()) && concurrent.owns(&shared_list.back()));
+		shared_list.clear();
+
+#ifdef ARENA_HAS_MEMORY_RESOURCE
+		auto growable = memory::make_growable_arena<node_block>(8);
+		memory::arena_memory_resource<decltype(growable)> resource(growable);
+
+		std::pmr::list<int> pmr_list(&resource);
+		for (int i = 0; i < 32; ++i) {
+			pmr_list.push_back(i);
+		}
+		assert(growable.owns(&pmr_list.front()) && growable.owns(&pmr_list.back()));
+		assert(growable.capacity() == 32);
+
+		// too big for a block, so it comes from upstream
+		std::pmr::vector<int> vector(64, 0, &resource);
+		assert(!growable.owns(vector.data()));
+#endif
+	}
+
+	// monotonic arenas bump allocate variable sizes, and free in bulk
+	{
+		memory::monotonic_arena scratch(256);
+		assert(scratch.capacity() == 256);
+
+		auto a = static_cast<char *>(scratch.allocate(3, 1));
+		auto b = scratch.allocate_array<double>(4);
+		auto c = scratch.allocate(10, 64);
+		assert(a && b && c);
+		assert(reinterpret_cast<uintptr_t>(b) % alignof(double) == 0);
+		assert(reinterpret_cast<uintptr_t>(c) % 64 == 0);
+		assert(reinterpret_cast<char *>(b) >= a + 3);
+
+		// rewinding hands the same memory out again
+		const auto m = scratch.mark();
+		auto d       = scratch.allocate(16);
+		scratch.rewind(m);
+		auto e = scratch.allocate(16);
+		assert(e == d);
+		scratch.rewind(m);
+
+		auto fill = [](memory::monotonic_arena &arena) {
+			for (int i = 0; i < 100; ++i) {
+				auto p = arena.allocate(40, 8);
+				assert(p);
+				std::memset(p, 0xff, 40);
+			}
+
+			// larger than any chunk so far
+			auto big = arena.allocate(10000);
+			assert(big);
+			std::memset(big, 0xff, 10000);
+		};
+
+		{
+			memory::monotonic_arena::scope guard(scratch);
+			fill(scratch);
+		}
+		e = scratch.allocate(16);
+		assert(e == d);
+
+		// reset keeps the chunks, so filling it again doesn't allocate more
+		const size_t capacity = scratch.capacity();
+		assert(capacity > 10000);
+		for (int round = 0; round < 3; ++round) {
+			scratch.reset();
+			fill(scratch);
+		}
+		assert(scratch.capacity() == capacity);
+
+		auto moved = std::move(scratch);
+		assert(moved.capacity() == capacity && scratch.capacity() == 0);
+
+		auto f = scratch.allocate(8);
+		assert(f && scratch.capacity() > 0);
+	}
+
+	// slab allocators serve small requests from the size classes, and pass
+	// large or over aligned ones through to malloc
+	{
+		memory::slab_allocator slabs;
+
+		assert(memory::slab_allocator::size_class(1) == 8);
+		assert(memory::slab_allocator::size_class(8) == 8);
+		assert(memory::slab_allocator::size_class(9) == 16);
+		assert(memory::slab_allocator::size_class(8, 16) == 16);
+		assert(memory::slab_allocator::size_class(4096) == 4096);
+		assert(memory::slab_allocator::size_class(4097) == 0);
+		assert(memory::slab_allocator::size_class(64, 128) == 0);
+
+		struct allocation {
+			void *p;
+			size_t size;
+		};
+
+		std::vector<allocation> live;
+		for (size_t size = 1; size <= 5000; size += 7) {
+			void *p = slabs.allocate(size);
+			assert(p);
+			assert(reinterpret_cast<uintptr_t>(p) % (size < alignof(std::max_align_t) ? 8 : alignof(std::max_align_t)) == 0);
+			assert(slabs.owns(p) == (size <= memory::slab_allocator::MaxSize));
+			std::memset(p, 0xaa, size);
+			live.push_back({p, size});
+		}
+
+		std::set<void *> distinct;
+		for (const allocation &a : live) {
+			distinct.insert(a.p);
+		}
+		assert(distinct.size() == live.size());
+
+		for (const allocation &a : live) {
+			slabs.deallocate(a.p, a.size);
+		}
+
+		// freed blocks are reused by the same size class
+		void *p1 = slabs.allocate(100);
+		slabs.deallocate(p1, 100);
+		void *p2 = slabs.allocate(120);
+		assert(p1 == p2);
+		slabs.deallocate(p2, 120);
+
+		void *aligned = slabs.allocate(24, 256);
+		assert(aligned && reinterpret_cast<uintptr_t>(aligned) % 256 == 0 && !slabs.owns(aligned));
+		std::memset(aligned, 0, 24);
+		slabs.deallocate(aligned, 24, 256);
+
+		void *small_aligned = slabs.allocate(4, 16);
+		assert(small_aligned && reinterpret_cast<uintptr_t>(small_aligned) % 16 == 0 && slabs.owns(small_aligned));
+		slabs.deallocate(small_aligned, 4, 16);
+	}
 }
@@ -29,24 +29,33 @@
 
 namespace bitwise {
 
+namespace detail {
+
 /*
  *  the reason why we need the "mask" constant is
  *  because some platforms make >> on negative values
  *  arithmetic (which shifts in the sign bit, not 0)
  *  using the mask allows this to work with both signed
  *  and unsigned types
+ *
+ *  n is already reduced modulo the width, and 0 is handled
+ *  separately so that neither shift is by the full width
  */
 template <class T>
-T rotate_left(T v, int n) noexcept {
-	constexpr unsigned int bits = CHAR_BIT * sizeof(T);
-	const T mask                = ~(T(-1) << n);
+constexpr T rotate_left(T v, unsigned int n) noexcept {
+	return n == 0 ? v : static_cast<T>((v << n) | ((v >> (CHAR_BIT * sizeof(T) - n)) & ~(T(-1) << n)));
+}
 
-	return (v << n) | ((v >> (bits - n)) & mask);
 }
 
 template <class T>
-T rotate_right(T v, int n) noexcept {
-	return rotate_left(v, -n);
+constexpr T rotate_left(T v, int n) noexcept {
+	return detail::rotate_left(v, static_cast<unsigned int>(n) % (CHAR_BIT * sizeof(T)));
+}
+
+template <class T>
+constexpr T rotate_right(T v, int n) noexcept {
+	return detail::rotate_left(v, (CHAR_BIT * sizeof(T) - static_cast<unsigned int>(n) % (CHAR_BIT * sizeof(T))) % (CHAR_BIT * sizeof(T)));
 }
 
 }
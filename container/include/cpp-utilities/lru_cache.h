@@ -8,25 +8,36 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
-template <class Key, class T>
+template <class Key, class T, class Hash = std::hash<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
 class lru_cache {
 public:
-	using value_type    = std::pair<Key, T>;
-	using list_type     = std::list<value_type>;
-	using list_iterator = typename list_type::iterator;
-	using map_type      = std::unordered_map<Key, list_iterator>;
-	using map_iterator  = typename map_type::iterator;
+	using value_type     = std::pair<Key, T>;
+	using allocator_type = Allocator;
+	using list_type      = std::list<value_type, typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>>;
+	using list_iterator  = typename list_type::iterator;
+	using map_allocator  = typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const Key, list_iterator>>;
+	using map_type       = std::unordered_map<Key, list_iterator, Hash, std::equal_to<Key>, map_allocator>;
+	using map_iterator   = typename map_type::iterator;
 
 public:
 	lru_cache(size_t capacity)
 		: capacity_(capacity) {}
 
+	lru_cache(size_t capacity, const Hash &hash)
+		: index_(0, hash), capacity_(capacity) {}
+
+	// every entry is two nodes, one in the recency list and one in the index,
+	// both are allocated with (a rebound copy of) alloc
+	lru_cache(size_t capacity, const Hash &hash, const Allocator &alloc)
+		: list_(alloc), index_(0, hash, std::equal_to<Key>(), map_allocator(alloc)), capacity_(capacity) {}
+
 	~lru_cache() {
 		clear();
 	}
@@ -1,8 +1,14 @@
 
+#include <cpp-utilities/arena.h>
+#include <cpp-utilities/arena_adapter.h>
 #include <cpp-utilities/lru_cache.h>
+#include <cpp-utilities/wyhash.h>
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
 
 int main() {
 
@@ -32,4 +38,37 @@ int main() {
 	}
 
 	std::cout << "CACHE SIZE: " << cache.size() << std::endl;
+
+	// a custom Hash, here a seeded wyhash
+	lru_cache<std::string, int, hash::wyhash_hasher> names(2, hash::wyhash_hasher{1234});
+	names.insert("one", 1);
+	names.insert("two", 2);
+	names.insert("three", 3);
+
+	assert(names.size() == 2);
+	assert(!names.exists("one"));
+	assert(names.fetch("three") == 3);
+
+	// the list and index nodes can come from an arena rather than the heap
+	{
+		struct alignas(std::max_align_t) node_block {
+			unsigned char bytes[64];
+		};
+
+		auto arena      = memory::make_growable_arena<node_block>(16);
+		using allocator = memory::arena_allocator_adapter<std::pair<int, int>, decltype(arena)>;
+
+		lru_cache<int, int, std::hash<int>, allocator> pooled(8, std::hash<int>(), allocator(arena));
+		for (int i = 0; i < 100; ++i) {
+			pooled.insert(i, i * i);
+		}
+
+		assert(pooled.size() == 8);
+		assert(pooled.fetch(99) == 99 * 99);
+		assert(!pooled.exists(91));
+
+		// there are at most 9 entries (before the oldest is evicted), each a
+		// list node and an index node, and evicted nodes are reused
+		assert(arena.capacity() == 32);
+	}
 }
@@ -0,0 +1,190 @@
+/*
+ * Throughput benchmark for the hashers. For every hasher, input size (16 B, 64 B,
+ * 256 B ... up to 1 GiB), buffer alignment and update path it prints one CSV row:
+ *
+ *   hasher,path,size,alignment,iterations,ns_per_byte,gb_per_s
+ *
+ * "bulk" feeds the whole buffer to update(const void *, size_t), "bytes" feeds
+ * it through an iterator which hides its contiguity so the hasher takes the
+ * byte at a time path.
+ *
+ * usage: cpp-utilities-hash-benchmark [--max-size BYTES] [--max-bytes-size BYTES]
+ *                                     [--min-bytes BYTES] [--hasher NAME]
+ */
+
+#include "cpp-utilities/crc32.h"
+#include "cpp-utilities/crc32c.h"
+#include "cpp-utilities/md5.h"
+#include "cpp-utilities/sha1.h"
+#include "cpp-utilities/sha256.h"
+#include "cpp-utilities/time_code.h"
+#include "cpp-utilities/wyhash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+// an iterator which hides the contiguity of the buffer, forcing the hashers
+// down their byte at a time path
+class byte_iterator {
+public:
+	using iterator_category = std::input_iterator_tag;
+	using value_type        = uint8_t;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = const uint8_t *;
+	using reference         = const uint8_t &;
+
+public:
+	explicit byte_iterator(const uint8_t *p)
+		: p_(p) {
+	}
+
+	reference operator*() const {
+		return *p_;
+	}
+
+	byte_iterator &operator++() {
+		++p_;
+		return *this;
+	}
+
+	byte_iterator operator++(int) {
+		byte_iterator tmp(*this);
+		++p_;
+		return tmp;
+	}
+
+	bool operator==(const byte_iterator &rhs) const {
+		return p_ == rhs.p_;
+	}
+
+	bool operator!=(const byte_iterator &rhs) const {
+		return p_ != rhs.p_;
+	}
+
+private:
+	const uint8_t *p_;
+};
+
+struct options {
+	std::size_t max_size       = std::size_t(1) << 30;
+	std::size_t max_bytes_size = std::size_t(64) << 20;
+	std::size_t min_bytes      = std::size_t(64) << 20;
+	std::string hasher;
+};
+
+// keeps the optimizer from discarding the digests
+volatile uint8_t sink;
+
+template <class Hasher>
+void hash_bulk(const uint8_t *p, std::size_t size) {
+	Hasher hasher;
+	hasher.update(p, size);
+	sink = sink ^ hasher.finalize().bytes()[0];
+}
+
+template <class Hasher>
+void hash_bytes(const uint8_t *p, std::size_t size) {
+	Hasher hasher(byte_iterator(p), byte_iterator(p + size));
+	sink = sink ^ hasher.finalize().bytes()[0];
+}
+
+template <class Hasher>
+void run(const char *name, const uint8_t *buffer, const options &opts) {
+	if (!opts.hasher.empty() && opts.hasher != name) {
+		return;
+	}
+
+	struct path {
+		const char *name;
+		void (*function)(const uint8_t *, std::size_t);
+		std::size_t max_size;
+	};
+
+	const path paths[] = {
+		{"bulk", hash_bulk<Hasher>, opts.max_size},
+		{"bytes", hash_bytes<Hasher>, opts.max_bytes_size},
+	};
+
+	for (const path &path : paths) {
+		for (std::size_t size = 16; size <= path.max_size; size *= 4) {
+			for (std::size_t alignment : {0, 1}) {
+				const uint8_t *p = buffer + alignment;
+
+				// small inputs are repeated so every measurement covers a
+				// reasonable amount of data
+				const std::size_t iterations = (size < opts.min_bytes) ? opts.min_bytes / size : 1;
+
+				auto elapsed = time_code_once<std::chrono::nanoseconds>([&]() {
+					for (std::size_t i = 0; i < iterations; ++i) {
+						path.function(p, size);
+					}
+				});
+
+				const double bytes       = static_cast<double>(size) * static_cast<double>(iterations);
+				const double ns_per_byte = static_cast<double>(elapsed.count()) / bytes;
+
+				std::printf("%s,%s,%zu,%s,%zu,%.4f,%.3f\n", name, path.name, size, alignment ? "unaligned" : "aligned", iterations, ns_per_byte, 1.0 / ns_per_byte);
+				std::fflush(stdout);
+			}
+		}
+	}
+}
+
+bool parse_options(int argc, char *argv[], options *opts) {
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = (i + 1 < argc);
+
+		if (std::strcmp(argv[i], "--max-size") == 0 && has_value) {
+			opts->max_size = std::stoull(argv[++i]);
+		} else if (std::strcmp(argv[i], "--max-bytes-size") == 0 && has_value) {
+			opts->max_bytes_size = std::stoull(argv[++i]);
+		} else if (std::strcmp(argv[i], "--min-bytes") == 0 && has_value) {
+			opts->min_bytes = std::stoull(argv[++i]);
+		} else if (std::strcmp(argv[i], "--hasher") == 0 && has_value) {
+			opts->hasher = argv[++i];
+		} else {
+			std::fprintf(stderr, "usage: %s [--max-size BYTES] [--max-bytes-size BYTES] [--min-bytes BYTES] [--hasher NAME]\n", argv[0]);
+			return false;
+		}
+	}
+
+	opts->max_bytes_size = std::min(opts->max_bytes_size, opts->max_size);
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+
+	options opts;
+	if (!parse_options(argc, argv, &opts)) {
+		return 1;
+	}
+
+	// one extra cache line so the unaligned runs stay in bounds, and so we
+	// can start on a 64 byte boundary
+	std::vector<uint8_t> storage(opts.max_size + 128);
+	uint8_t *buffer = storage.data() + (64 - reinterpret_cast<uintptr_t>(storage.data()) % 64);
+
+	uint32_t x = 0x12345678;
+	for (uint8_t &byte : storage) {
+		x    = x * 1103515245 + 12345;
+		byte = static_cast<uint8_t>(x >> 24);
+	}
+
+	std::printf("hasher,path,size,alignment,iterations,ns_per_byte,gb_per_s\n");
+
+	run<hash::crc32>("crc32", buffer, opts);
+	run<hash::crc32c>("crc32c", buffer, opts);
+	run<hash::md5>("md5", buffer, opts);
+	run<hash::sha1>("sha1", buffer, opts);
+	run<hash::sha256>("sha256", buffer, opts);
+	run<hash::wyhash>("wyhash", buffer, opts);
+}
@@ -0,0 +1,217 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHUNKER_20261017_H_
+#define CHUNKER_20261017_H_
+
+#include <algorithm>
+#include <cpp-utilities/gear.h>
+#include <cpp-utilities/sha1.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hash {
+
+struct chunker_options {
+	std::size_t min_size = 2 * 1024;
+	std::size_t avg_size = 8 * 1024;
+	std::size_t max_size = 64 * 1024;
+
+	// fill in chunk::digest with the sha1 of each chunk
+	bool digest = false;
+};
+
+struct chunk {
+	uint64_t offset  = 0;
+	std::size_t size = 0;
+	sha1::digest digest;
+};
+
+/**
+ * Content defined chunking, FastCDC style. A stream is split wherever the
+ * gear hash of the preceding bytes has enough zero bits, so boundaries move
+ * with the content: inserting or removing bytes only changes the chunks
+ * around the edit, which is what makes this useful for deduplication.
+ *
+ * As in FastCDC, the first min_size bytes of a chunk are never a boundary
+ * and so aren't even hashed, and "normalized chunking" is used: a stricter
+ * mask before avg_size and a looser one after it, which keeps most chunks
+ * close to avg_size. A chunk is always cut at max_size.
+ *
+ * Data is fed in with update() in pieces of any size, and callback(const
+ * chunk &) is called for every chunk as soon as its end is found. flush()
+ * emits whatever is left as the final chunk.
+ */
+class chunker {
+public:
+	explicit chunker(const chunker_options &options = chunker_options())
+		: digest_(options.digest) {
+
+		max_ = std::max<std::size_t>(options.max_size, 1);
+		min_ = std::min(options.min_size, max_);
+		avg_ = std::min(std::max(options.avg_size, min_), max_);
+
+		// normalization level 2, two more bits than avg_size would need before
+		// it and two fewer after. The top bits are the ones which depend on the
+		// most bytes, so the mask is taken from those
+		unsigned bits = 0;
+		while ((std::size_t(2) << bits) <= avg_) {
+			++bits;
+		}
+
+		mask_small_ = ~uint64_t(0) << (64 - std::min(bits + 2, 63u));
+		mask_large_ = (bits > 2) ? ~uint64_t(0) << (64 - (bits - 2)) : 0;
+	}
+
+public:
+	template <class Callback>
+	void update(const void *data, std::size_t size, Callback &&callback) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		while (size != 0) {
+			bool cut            = false;
+			const std::size_t n = scan(p, size, &cut);
+
+			if (digest_) {
+				sha1_.update(p, n);
+			}
+
+			size_ += n;
+			p += n;
+			size -= n;
+
+			if (cut) {
+				emit(callback);
+			}
+		}
+	}
+
+	template <class Callback>
+	void update(const std::string &s, Callback &&callback) {
+		update(s.data(), s.size(), callback);
+	}
+
+	// emits the final chunk, if there is one, and starts again at offset 0
+	template <class Callback>
+	void flush(Callback &&callback) {
+		if (size_ != 0) {
+			emit(callback);
+		}
+		offset_ = 0;
+	}
+
+	// the offset in the stream of the current (unfinished) chunk
+	uint64_t offset() const {
+		return offset_;
+	}
+
+private:
+	/*
+	 * returns how many bytes of [p, p + size) belong to the current chunk,
+	 * setting *cut if the chunk ends there
+	 */
+	std::size_t scan(const uint8_t *p, std::size_t size, bool *cut) {
+		const uint64_t *table = detail::gear_table();
+
+		// the positions (relative to p) where the chunk would reach each limit
+		const std::size_t start = std::min(size, (min_ > size_) ? min_ - size_ : 0);
+		const std::size_t avg   = std::min(size, (avg_ > size_) ? avg_ - size_ : 0);
+		const std::size_t max   = std::min(size, max_ - size_);
+
+		uint64_t h    = hash_;
+		std::size_t i = start;
+
+		// one lookup, shift, add and (almost never taken) branch per byte
+		for (; i < avg; ++i) {
+			h = (h << 1) + table[p[i]];
+			if (!(h & mask_small_)) {
+				*cut = true;
+				return i + 1;
+			}
+		}
+
+		for (; i < max; ++i) {
+			h = (h << 1) + table[p[i]];
+			if (!(h & mask_large_)) {
+				*cut = true;
+				return i + 1;
+			}
+		}
+
+		hash_ = h;
+		*cut  = (size_ + max == max_);
+		return max;
+	}
+
+	template <class Callback>
+	void emit(Callback &callback) {
+		chunk c;
+		c.offset = offset_;
+		c.size   = size_;
+		if (digest_) {
+			c.digest = sha1_.finalize();
+			sha1_.clear();
+		}
+
+		offset_ += size_;
+		size_ = 0;
+		hash_ = 0;
+
+		callback(static_cast<const chunk &>(c));
+	}
+
+private:
+	std::size_t min_;
+	std::size_t avg_;
+	std::size_t max_;
+	uint64_t mask_small_;
+	uint64_t mask_large_;
+	bool digest_;
+
+	uint64_t offset_  = 0; // offset of the current chunk
+	std::size_t size_ = 0; // bytes in the current chunk so far
+	uint64_t hash_    = 0;
+	sha1 sha1_;
+};
+
+/**
+ * Splits [data, data + size) into content defined chunks
+ */
+inline std::vector<chunk> chunk_buffer(const void *data, std::size_t size, const chunker_options &options = chunker_options()) {
+	std::vector<chunk> chunks;
+	auto add = [&chunks](const chunk &c) {
+		chunks.push_back(c);
+	};
+
+	chunker c(options);
+	c.update(data, size, add);
+	c.flush(add);
+	return chunks;
+}
+
+}
+
+#endif
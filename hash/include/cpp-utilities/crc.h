@@ -0,0 +1,415 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CRC_20261017_H_
+#define CRC_20261017_H_
+
+#include <algorithm>
+#include <array>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hex.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace hash {
+
+namespace detail {
+
+template <unsigned Width>
+using crc_value_type = typename std::conditional<
+	(Width <= 8), uint8_t,
+	typename std::conditional<
+		(Width <= 16), uint16_t,
+		typename std::conditional<(Width <= 32), uint32_t, uint64_t>::type>::type>::type;
+
+// single return (recursive) so that it is usable in C++11 constant expressions
+constexpr uint64_t reflect_bits(uint64_t value, unsigned width) {
+	return width == 0 ? 0 : (((value & 1) << (width - 1)) | reflect_bits(value >> 1, width - 1));
+}
+
+template <class T, std::size_t Slices>
+struct crc_table_type {
+	T data[Slices][256];
+};
+
+template <class T, unsigned Width, bool Reflect>
+constexpr T crc_next(T crc, uint8_t byte, const T *table) {
+	return Reflect ? static_cast<T>((Width > 8 ? (crc >> 8) : 0) ^ table[static_cast<uint8_t>(crc) ^ byte])
+				   : static_cast<T>(((Width > 8 ? (crc << 8) : 0) ^ table[static_cast<uint8_t>(crc >> (Width - 8)) ^ byte]) & (~uint64_t(0) >> (64 - Width)));
+}
+
+/*
+ * data[0] is the classic byte at a time table and data[k] advances
+ * data[k - 1] by one more zero byte, which is what the slicing-by-N kernels
+ * need to process N bytes per step with N independent lookups
+ */
+template <class T, std::size_t Slices, unsigned Width, bool Reflect>
+HASH_CONSTEXPR14 crc_table_type<T, Slices> make_crc_tables(T poly) {
+	crc_table_type<T, Slices> tables = {};
+
+	const T top_bit = static_cast<T>(uint64_t(1) << (Width - 1));
+	const T mask    = static_cast<T>(~uint64_t(0) >> (64 - Width));
+
+	for (unsigned n = 0; n < 256; ++n) {
+		T c = Reflect ? static_cast<T>(n) : static_cast<T>(T(n) << (Width - 8));
+		for (int k = 0; k < 8; ++k) {
+			if (Reflect) {
+				c = (c & 1) ? static_cast<T>((c >> 1) ^ poly) : static_cast<T>(c >> 1);
+			} else {
+				c = (c & top_bit) ? static_cast<T>((c << 1) ^ poly) : static_cast<T>(c << 1);
+			}
+		}
+		tables.data[0][n] = static_cast<T>(c & mask);
+	}
+
+	for (std::size_t k = 1; k < Slices; ++k) {
+		for (unsigned n = 0; n < 256; ++n) {
+			tables.data[k][n] = crc_next<T, Width, Reflect>(tables.data[k - 1][n], 0, tables.data[0]);
+		}
+	}
+
+	return tables;
+}
+
+/*
+ * The table driven CRC kernels for a given polynomial. Reflected CRCs are
+ * processed LSB first with a right shifting register, the others MSB first
+ * with a left shifting one.
+ */
+template <unsigned Width, uint64_t Poly, bool Reflect>
+struct crc_engine {
+	static_assert(Width >= 8 && Width <= 64 && Width % 8 == 0, "CRC width must be a whole number of bytes between 8 and 64 bits");
+
+	using value_type = crc_value_type<Width>;
+
+	static constexpr std::size_t Slices = 16;
+
+	static constexpr value_type mask = static_cast<value_type>(~uint64_t(0) >> (64 - Width));
+	static constexpr value_type poly = static_cast<value_type>(Reflect ? reflect_bits(Poly, Width) : Poly);
+
+#ifdef HASH_HAS_CONSTEXPR14
+	static constexpr crc_table_type<value_type, Slices> table_data = make_crc_tables<value_type, Slices, Width, Reflect>(poly);
+
+	static constexpr const crc_table_type<value_type, Slices> &tables() {
+		return table_data;
+	}
+#else
+	// without C++14 constexpr the tables are built the first time they're used
+	static const crc_table_type<value_type, Slices> &tables() {
+		static const crc_table_type<value_type, Slices> table_data = make_crc_tables<value_type, Slices, Width, Reflect>(poly);
+		return table_data;
+	}
+#endif
+
+	static HASH_CONSTEXPR14 value_type update(value_type crc, uint8_t byte) {
+		return crc_next<value_type, Width, Reflect>(crc, byte, tables().data[0]);
+	}
+
+	/*
+	 * reads 8 bytes in the order they are shifted into the register, the
+	 * compiler will turn this into a single (possibly byte swapped) load
+	 */
+	static constexpr uint64_t load(const uint8_t *p) {
+		return Reflect ? (uint64_t(p[0]) << 0x00) | (uint64_t(p[1]) << 0x08) | (uint64_t(p[2]) << 0x10) | (uint64_t(p[3]) << 0x18) |
+							 (uint64_t(p[4]) << 0x20) | (uint64_t(p[5]) << 0x28) | (uint64_t(p[6]) << 0x30) | (uint64_t(p[7]) << 0x38)
+					   : (uint64_t(p[0]) << 0x38) | (uint64_t(p[1]) << 0x30) | (uint64_t(p[2]) << 0x28) | (uint64_t(p[3]) << 0x20) |
+							 (uint64_t(p[4]) << 0x18) | (uint64_t(p[5]) << 0x10) | (uint64_t(p[6]) << 0x08) | (uint64_t(p[7]) << 0x00);
+	}
+
+	// the register aligned so that it lines up with the first bytes of a load
+	static constexpr uint64_t align(value_type crc) {
+		return Reflect ? uint64_t(crc) : (uint64_t(crc) << (64 - Width));
+	}
+
+	static constexpr uint8_t byte_at(uint64_t word, int i) {
+		return static_cast<uint8_t>(Reflect ? (word >> (8 * i)) : (word >> (56 - 8 * i)));
+	}
+
+	// advances 8 bytes of input, Offset more bytes of zeros
+	template <std::size_t Offset>
+	static HASH_CONSTEXPR14 value_type fold(uint64_t word) {
+		return tables().data[Offset + 7][byte_at(word, 0)] ^
+			   tables().data[Offset + 6][byte_at(word, 1)] ^
+			   tables().data[Offset + 5][byte_at(word, 2)] ^
+			   tables().data[Offset + 4][byte_at(word, 3)] ^
+			   tables().data[Offset + 3][byte_at(word, 4)] ^
+			   tables().data[Offset + 2][byte_at(word, 5)] ^
+			   tables().data[Offset + 1][byte_at(word, 6)] ^
+			   tables().data[Offset + 0][byte_at(word, 7)];
+	}
+
+	static HASH_CONSTEXPR14 value_type update_slice8(value_type crc, const uint8_t *&p, std::size_t &n) {
+		while (n >= 8) {
+			crc = fold<0>(load(p) ^ align(crc));
+			p += 8;
+			n -= 8;
+		}
+		return crc;
+	}
+
+	static HASH_CONSTEXPR14 value_type update_slice16(value_type crc, const uint8_t *&p, std::size_t &n) {
+		while (n >= 16) {
+			crc = static_cast<value_type>(fold<8>(load(p) ^ align(crc)) ^ fold<0>(load(p + 8)));
+			p += 16;
+			n -= 16;
+		}
+		return crc;
+	}
+
+	/*
+	 * multiplies a and b modulo the polynomial, for reflected CRCs x^0 is the
+	 * most significant bit of the register, otherwise it is the least
+	 */
+	static constexpr value_type multiply(value_type a, value_type b) {
+		return multiply(a, b, 0, 0);
+	}
+
+	// x^n modulo the polynomial
+	static constexpr value_type xpow(uint64_t n) {
+		return xpow(n, Reflect ? static_cast<value_type>(uint64_t(1) << (Width - 1)) : 1, Reflect ? static_cast<value_type>(uint64_t(1) << (Width - 2)) : 2);
+	}
+
+	// the register after feeding it size zero bytes
+	static constexpr value_type shift(value_type crc, uint64_t size) {
+		return multiply(crc, xpow(size * 8));
+	}
+
+	static HASH_CONSTEXPR14 value_type update(value_type crc, const uint8_t *p, std::size_t n) {
+		crc = update_slice16(crc, p, n);
+		crc = update_slice8(crc, p, n);
+		while (n--) {
+			crc = update(crc, *p++);
+		}
+		return crc;
+	}
+
+private:
+	/*
+	 * multiply and xpow are written as single return recursion, which the
+	 * compiler turns back into loops, so that they are usable in C++11
+	 * constant expressions
+	 */
+	static constexpr bool multiplier_bit(value_type a, unsigned i) {
+		return Reflect ? ((a >> (Width - 1 - i)) & 1) : ((a >> i) & 1);
+	}
+
+	// b * x
+	static constexpr value_type times_x(value_type b) {
+		return Reflect ? ((b & 1) ? static_cast<value_type>((b >> 1) ^ poly) : static_cast<value_type>(b >> 1))
+					   : (((b >> (Width - 1)) & 1) ? static_cast<value_type>(((b << 1) ^ poly) & mask) : static_cast<value_type>((b << 1) & mask));
+	}
+
+	static constexpr value_type multiply(value_type a, value_type b, unsigned i, value_type product) {
+		return i == Width ? product : multiply(a, times_x(b), i + 1, multiplier_bit(a, i) ? static_cast<value_type>(product ^ b) : product);
+	}
+
+	static constexpr value_type xpow(uint64_t n, value_type result, value_type square) {
+		return n == 0 ? result : xpow(n >> 1, (n & 1) ? multiply(result, square) : result, multiply(square, square));
+	}
+};
+
+#ifdef HASH_HAS_CONSTEXPR14
+template <unsigned Width, uint64_t Poly, bool Reflect>
+constexpr crc_table_type<typename crc_engine<Width, Poly, Reflect>::value_type, crc_engine<Width, Poly, Reflect>::Slices> crc_engine<Width, Poly, Reflect>::table_data;
+#endif
+
+}
+
+/*
+ * A generic CRC following the usual parameterized model. Poly is given in
+ * normal (MSB first) form, when Reflect is true both the input bytes and the
+ * result are bit reflected, which is the case for most CRCs in use today.
+ * Init is the initial register value and XorOut is applied to the final
+ * value.
+ */
+template <unsigned Width, uint64_t Poly, bool Reflect, uint64_t Init, uint64_t XorOut>
+class crc : public detail::string_updates<crc<Width, Poly, Reflect, Init, XorOut>> {
+	using engine = detail::crc_engine<Width, Poly, Reflect>;
+
+public:
+	using value_type = typename engine::value_type;
+
+private:
+	static constexpr value_type initial = static_cast<value_type>(Reflect ? detail::reflect_bits(Init, Width) : (Init & engine::mask));
+	static constexpr value_type xorout  = static_cast<value_type>(XorOut & engine::mask);
+
+public:
+	class digest {
+		friend class crc;
+
+	public:
+		static constexpr std::size_t HexSize = Width / 4;
+
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
+			}
+
+			detail::hex_encode_value<Width / 8>(h_, first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
+			return str;
+		}
+
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
+		std::array<uint8_t, Width / 8> bytes() const {
+			std::array<uint8_t, Width / 8> b;
+			for (unsigned i = 0; i < Width / 8; ++i) {
+				b[i] = static_cast<uint8_t>(h_ >> (i * 8));
+			}
+			return b;
+		}
+
+		constexpr value_type value() const {
+			return h_;
+		}
+
+		constexpr bool operator==(const digest &rhs) const {
+			return h_ == rhs.h_;
+		}
+
+		constexpr bool operator!=(const digest &rhs) const {
+			return !(*this == rhs);
+		}
+
+	private:
+		value_type h_ = initial;
+	};
+
+public:
+	template <class In>
+	crc(In first, In last) {
+		update(first, last);
+	}
+
+	crc(const std::string &s) {
+		update(s);
+	}
+
+	template <class Char, std::size_t N, class = detail::if_string_literal<Char>>
+	HASH_CONSTEXPR14 crc(Char (&s)[N]) {
+		update(s);
+	}
+
+#if __cplusplus >= 201703L
+	template <class View, class = detail::if_string_view<View>>
+	HASH_CONSTEXPR14 crc(View s) {
+		update(s);
+	}
+#endif
+
+	crc()                          = default;
+	crc(const crc &other)          = default;
+	crc &operator=(const crc &rhs) = default;
+
+public:
+	template <class In>
+	crc &update(In first, In last) {
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
+		return *this;
+	}
+
+	HASH_CONSTEXPR14 crc &update(uint8_t byte) {
+		digest_.h_ = engine::update(digest_.h_, byte);
+		return *this;
+	}
+
+	crc &update(const std::string &s) {
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	using detail::string_updates<crc>::update;
+
+	crc &update(const void *data, std::size_t size) {
+		digest_.h_ = engine::update(digest_.h_, static_cast<const uint8_t *>(data), size);
+		return *this;
+	}
+
+public:
+	void swap(crc &other) {
+		using std::swap;
+		swap(digest_, other.digest_);
+	}
+
+	void clear() {
+		digest_ = digest();
+	}
+
+	HASH_CONSTEXPR14 digest finalize() const {
+		digest d = digest_;
+		d.h_     = static_cast<value_type>(d.h_ ^ xorout);
+		return d;
+	}
+
+public:
+	/*
+	 * Given the finalized CRCs of two messages A and B, returns the CRC of
+	 * A followed by B, without needing to see the data again
+	 */
+	static HASH_CONSTEXPR14 digest combine(const digest &crc_a, const digest &crc_b, uint64_t size_b) {
+		digest d;
+		d.h_ = static_cast<value_type>(engine::shift(static_cast<value_type>(crc_a.h_ ^ initial ^ xorout), size_b) ^ crc_b.h_);
+		return d;
+	}
+
+private:
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(*first++);
+		}
+	}
+
+private:
+	digest digest_;
+};
+
+// some common variants, named after their entries in the CRC catalogue
+using crc16_arc         = crc<16, 0x8005, true, 0x0000, 0x0000>;
+using crc16_ccitt_false = crc<16, 0x1021, false, 0xffff, 0x0000>;
+using crc32_bzip2       = crc<32, 0x04c11db7, false, 0xffffffff, 0xffffffff>;
+using crc64_xz          = crc<64, 0x42f0e1eba9ea3693, true, 0xffffffffffffffff, 0xffffffffffffffff>;
+
+}
+
+#endif
@@ -0,0 +1,305 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CRC32C_20261017_H_
+#define CRC32C_20261017_H_
+
+#include <algorithm>
+#include <array>
+#include <cpp-utilities/crc.h>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hex.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace hash {
+
+namespace detail {
+
+/* Castagnoli polynomial */
+using crc32c_engine = crc_engine<32, 0x1edc6f41, true>;
+
+inline uint32_t crc32c_portable(uint32_t crc, const uint8_t *p, std::size_t n) {
+	return crc32c_engine::update(crc, p, n);
+}
+
+#ifdef HASH_X86_64_DISPATCH
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(uint32_t crc, const uint8_t *p, std::size_t n) {
+	uint64_t crc64 = crc;
+	while (n >= 8) {
+		uint64_t word;
+		std::memcpy(&word, p, sizeof(word));
+		crc64 = _mm_crc32_u64(crc64, word);
+		p += 8;
+		n -= 8;
+	}
+
+	crc = static_cast<uint32_t>(crc64);
+	while (n--) {
+		crc = _mm_crc32_u8(crc, *p++);
+	}
+	return crc;
+}
+
+/*
+ * The crc32 instruction has a latency of 3 cycles but a throughput of 1 per
+ * cycle, so a single dependency chain only uses a third of the hardware. This
+ * runs three independent streams over adjacent blocks and then uses carry-less
+ * multiplication to shift the earlier streams' CRCs over the later blocks
+ * before merging them:
+ *
+ *   crc(A|B|C) = crc(A) * x^(16 * Block) ^ crc(B) * x^(8 * Block) ^ crc(C)
+ *
+ * where multiplying by x^k is clmul(crc, x^(k - 33) mod P) reduced by one
+ * more crc32 instruction. This is the same operation as crc_engine::shift,
+ * just done in hardware.
+ */
+template <std::size_t Block>
+__attribute__((target("sse4.2,pclmul"))) inline uint32_t crc32c_3way(uint32_t crc, const uint8_t *&p, std::size_t &n) {
+	static_assert(Block % 8 == 0, "Block must be a multiple of 8");
+
+	constexpr uint32_t k1 = crc32c_engine::xpow(Block * 8 - 33);
+	constexpr uint32_t k2 = crc32c_engine::xpow(Block * 16 - 33);
+
+	while (n >= Block * 3) {
+		uint64_t crc0 = crc;
+		uint64_t crc1 = 0;
+		uint64_t crc2 = 0;
+
+		for (std::size_t i = 0; i < Block; i += 8) {
+			uint64_t w0;
+			uint64_t w1;
+			uint64_t w2;
+			std::memcpy(&w0, p + i, sizeof(w0));
+			std::memcpy(&w1, p + i + Block, sizeof(w1));
+			std::memcpy(&w2, p + i + Block * 2, sizeof(w2));
+			crc0 = _mm_crc32_u64(crc0, w0);
+			crc1 = _mm_crc32_u64(crc1, w1);
+			crc2 = _mm_crc32_u64(crc2, w2);
+		}
+
+		const __m128i t0 = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc0)), _mm_cvtsi32_si128(static_cast<int>(k2)), 0x00);
+		const __m128i t1 = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc1)), _mm_cvtsi32_si128(static_cast<int>(k1)), 0x00);
+		const uint64_t folded = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_xor_si128(t0, t1)));
+
+		crc = static_cast<uint32_t>(_mm_crc32_u64(0, folded) ^ crc2);
+		p += Block * 3;
+		n -= Block * 3;
+	}
+
+	return crc;
+}
+
+__attribute__((target("sse4.2,pclmul"))) inline uint32_t crc32c_sse42_pclmul(uint32_t crc, const uint8_t *p, std::size_t n) {
+	// get to an 8 byte boundary so that the main loops do aligned loads
+	while (n != 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+		--n;
+	}
+
+	crc = crc32c_3way<8192>(crc, p, n);
+	crc = crc32c_3way<256>(crc, p, n);
+	return crc32c_sse42(crc, p, n);
+}
+#endif
+
+using crc32c_function = uint32_t (*)(uint32_t, const uint8_t *, std::size_t);
+
+inline crc32c_function select_crc32c() {
+#ifdef HASH_X86_64_DISPATCH
+	if (cpu().sse42 && cpu().pclmul) {
+		return crc32c_sse42_pclmul;
+	}
+
+	if (cpu().sse42) {
+		return crc32c_sse42;
+	}
+#endif
+	return crc32c_portable;
+}
+
+inline uint32_t crc32c_update(uint32_t crc, const uint8_t *p, std::size_t n) {
+	static const crc32c_function function = select_crc32c();
+	return function(crc, p, n);
+}
+
+}
+
+class crc32c : public detail::string_updates<crc32c> {
+public:
+	class digest {
+		friend class crc32c;
+
+	public:
+		static constexpr std::size_t HexSize = 8;
+
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
+			}
+
+			detail::hex_encode_value<4>(h_, first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
+			return str;
+		}
+
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
+		std::array<uint8_t, 4> bytes() const {
+			std::array<uint8_t, 4> b;
+			b[0] = (h_ & 0x000000ff);
+			b[1] = (h_ & 0x0000ff00) >> 8;
+			b[2] = (h_ & 0x00ff0000) >> 16;
+			b[3] = (h_ & 0xff000000) >> 24;
+			return b;
+		}
+
+		constexpr uint32_t value() const {
+			return h_;
+		}
+
+		constexpr bool operator==(const digest &rhs) const {
+			return h_ == rhs.h_;
+		}
+
+		constexpr bool operator!=(const digest &rhs) const {
+			return !(*this == rhs);
+		}
+
+	private:
+		uint32_t h_ = ~0;
+	};
+
+public:
+	template <class In>
+	crc32c(In first, In last) {
+		update(first, last);
+	}
+
+	crc32c(const std::string &s) {
+		update(s);
+	}
+
+	template <class Char, std::size_t N, class = detail::if_string_literal<Char>>
+	HASH_CONSTEXPR14 crc32c(Char (&s)[N]) {
+		update(s);
+	}
+
+#if __cplusplus >= 201703L
+	template <class View, class = detail::if_string_view<View>>
+	HASH_CONSTEXPR14 crc32c(View s) {
+		update(s);
+	}
+#endif
+
+	crc32c()                             = default;
+	crc32c(const crc32c &other)          = default;
+	crc32c &operator=(const crc32c &rhs) = default;
+
+public:
+	template <class In>
+	crc32c &update(In first, In last) {
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
+		return *this;
+	}
+
+	HASH_CONSTEXPR14 crc32c &update(uint8_t byte) {
+		digest_.h_ = detail::crc32c_engine::update(digest_.h_, byte);
+		return *this;
+	}
+
+	crc32c &update(const std::string &s) {
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	using detail::string_updates<crc32c>::update;
+
+	crc32c &update(const void *data, std::size_t size) {
+		digest_.h_ = detail::crc32c_update(digest_.h_, static_cast<const uint8_t *>(data), size);
+		return *this;
+	}
+
+public:
+	void swap(crc32c &other) {
+		using std::swap;
+		swap(digest_, other.digest_);
+	}
+
+	void clear() {
+		digest_ = digest();
+	}
+
+	HASH_CONSTEXPR14 digest finalize() const {
+		digest d = digest_;
+		/* invert all bits, and we're done */
+		d.h_ = ~d.h_;
+		return d;
+	}
+
+public:
+	/*
+	 * Given the finalized CRCs of two messages A and B, returns the CRC of
+	 * A followed by B, without needing to see the data again
+	 */
+	static HASH_CONSTEXPR14 digest combine(const digest &crc_a, const digest &crc_b, uint64_t size_b) {
+		digest d;
+		d.h_ = detail::crc32c_engine::shift(crc_a.h_, size_b) ^ crc_b.h_;
+		return d;
+	}
+
+private:
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(*first++);
+		}
+	}
+
+private:
+	digest digest_;
+};
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GEAR_20261017_H_
+#define GEAR_20261017_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hash {
+namespace detail {
+
+struct gear_table_type {
+	uint64_t data[256];
+};
+
+// 256 random looking 64-bit values, from splitmix64
+constexpr gear_table_type make_gear_table(uint64_t seed) {
+	gear_table_type table = {};
+	for (int i = 0; i < 256; ++i) {
+		seed += 0x9e3779b97f4a7c15;
+
+		uint64_t z = seed;
+		z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+		table.data[i] = z ^ (z >> 31);
+	}
+	return table;
+}
+
+inline const uint64_t *gear_table() {
+	static constexpr gear_table_type table = make_gear_table(0x6765617248617368);
+	return table.data;
+}
+
+}
+
+/**
+ * The "gear" rolling hash used by FastCDC. Each byte shifts the hash left
+ * by one and adds a random value for the byte, so a byte's influence is
+ * shifted out after 64 more, and the top bits of value() depend on (at
+ * most) the last 64 bytes. It costs a table lookup, a shift and an add per
+ * byte, making it a good fit for finding content defined boundaries.
+ */
+class gear {
+public:
+	gear() = default;
+
+	explicit gear(uint64_t value)
+		: h_(value) {
+	}
+
+public:
+	gear &update(uint8_t byte) {
+		h_ = (h_ << 1) + detail::gear_table()[byte];
+		return *this;
+	}
+
+	gear &update(const void *data, std::size_t size) {
+		auto p                = static_cast<const uint8_t *>(data);
+		const uint64_t *table = detail::gear_table();
+
+		uint64_t h = h_;
+		for (std::size_t i = 0; i < size; ++i) {
+			h = (h << 1) + table[p[i]];
+		}
+
+		h_ = h;
+		return *this;
+	}
+
+	uint64_t value() const {
+		return h_;
+	}
+
+	void clear() {
+		h_ = 0;
+	}
+
+private:
+	uint64_t h_ = 0;
+};
+
+}
+
+#endif
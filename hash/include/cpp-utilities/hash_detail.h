@@ -0,0 +1,225 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HASH_DETAIL_20261017_H_
+#define HASH_DETAIL_20261017_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+// the accelerated code paths are written using GCC/Clang function level
+// target attributes, so they can live in headers without requiring the
+// whole program to be compiled with -msse4.2 and friends
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HASH_X86_64_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// GCC/Clang vector extensions let us write SIMD code once for any width
+#if defined(__GNUC__)
+#define HASH_VECTOR_EXTENSIONS
+#define HASH_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define HASH_ALWAYS_INLINE inline
+#endif
+
+// functions which need C++14's relaxed constexpr rules (loops, more than a
+// single return) are only constexpr from C++14 on, C++11 gets them as
+// ordinary runtime functions
+#if __cplusplus >= 201402L || (defined(__cpp_constexpr) && __cpp_constexpr >= 201304L)
+#define HASH_HAS_CONSTEXPR14
+#define HASH_CONSTEXPR14 constexpr
+#else
+#define HASH_CONSTEXPR14 inline
+#endif
+
+// lets the hashers take their fast (non-constexpr) paths at runtime while
+// still being usable in constant expressions
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define HASH_HAS_IS_CONSTANT_EVALUATED
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define HASH_HAS_IS_CONSTANT_EVALUATED
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define HASH_HAS_IS_CONSTANT_EVALUATED
+#endif
+
+namespace hash {
+namespace detail {
+
+/*
+ * true while being evaluated as part of a constant expression. When the
+ * compiler can't tell us we have to answer true, which just means that the
+ * constexpr friendly code paths are also used at runtime.
+ */
+constexpr bool in_constant_evaluation() noexcept {
+#ifdef HASH_HAS_IS_CONSTANT_EVALUATED
+	return __builtin_is_constant_evaluated();
+#else
+	return true;
+#endif
+}
+
+/*
+ * The string literal overloads only match const char arrays. A mutable
+ * buffer decays to a pointer and braced lists such as {'a', 0, 'b'} build a
+ * std::string, exactly as they did before these overloads existed.
+ */
+template <class Char>
+using if_string_literal = typename std::enable_if<std::is_same<Char, const char>::value>::type;
+
+#if __cplusplus >= 201703L
+// the string_view overloads are templates limited to std::string_view itself,
+// so a const char * keeps going to the std::string overloads rather than
+// becoming ambiguous between the two
+template <class View>
+using if_string_view = typename std::enable_if<std::is_same<View, std::string_view>::value>::type;
+#endif
+
+/*
+ * The update overloads which let a hasher be used in constant expressions,
+ * shared by every hasher which supports it. Derived provides
+ * update(uint8_t), which must be constexpr, and update(const void *, size),
+ * which is used at runtime so that literals still take the bulk paths.
+ */
+template <class Derived>
+class string_updates {
+public:
+	// every byte but the literal's terminator, embedded NULs included
+	template <class Char, std::size_t N, class = if_string_literal<Char>>
+	HASH_CONSTEXPR14 Derived &update(Char (&s)[N]) {
+		return update_chars(s, N - 1);
+	}
+
+#if __cplusplus >= 201703L
+	template <class View, class = if_string_view<View>>
+	HASH_CONSTEXPR14 Derived &update(View s) {
+		return update_chars(s.data(), s.size());
+	}
+#endif
+
+private:
+	HASH_CONSTEXPR14 Derived &update_chars(const char *s, std::size_t n) {
+		Derived &self = static_cast<Derived &>(*this);
+		if (in_constant_evaluation()) {
+			for (std::size_t i = 0; i < n; ++i) {
+				self.update(static_cast<uint8_t>(s[i]));
+			}
+		} else {
+			self.update(static_cast<const void *>(s), n);
+		}
+		return self;
+	}
+};
+
+/*
+ * is_contiguous_byte_iterator<In>::value is true when [first, last) is known
+ * to be a contiguous run of byte sized elements. Hashers use this to route
+ * such ranges to their bulk update paths instead of feeding them one byte at
+ * a time.
+ */
+template <class In, class T = typename std::iterator_traits<In>::value_type>
+struct is_contiguous_byte_iterator
+	: std::integral_constant<bool,
+							 sizeof(T) == 1 && !std::is_same<T, bool>::value &&
+								 (std::is_pointer<In>::value ||
+								  std::is_same<In, std::string::iterator>::value ||
+								  std::is_same<In, std::string::const_iterator>::value ||
+								  std::is_same<In, typename std::vector<T>::iterator>::value ||
+								  std::is_same<In, typename std::vector<T>::const_iterator>::value)> {};
+
+struct cpu_features {
+	bool sse41   = false;
+	bool sse42   = false;
+	bool pclmul  = false;
+	bool avx2    = false;
+	bool avx512f = false;
+	bool sha     = false;
+};
+
+#ifdef HASH_X86_64_DISPATCH
+inline cpu_features detect_cpu_features() {
+	cpu_features features;
+
+	unsigned int eax;
+	unsigned int ebx;
+	unsigned int ecx;
+	unsigned int edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return features;
+	}
+
+	features.sse41  = (ecx & bit_SSE4_1) != 0;
+	features.sse42  = (ecx & bit_SSE4_2) != 0;
+	features.pclmul = (ecx & bit_PCLMUL) != 0;
+
+	// the wider registers are only usable if the OS saves them on a context switch
+	uint64_t xcr0 = 0;
+	if (ecx & bit_OSXSAVE) {
+		unsigned int lo;
+		unsigned int hi;
+		__asm__("xgetbv"
+				: "=a"(lo), "=d"(hi)
+				: "c"(0));
+		xcr0 = (static_cast<uint64_t>(hi) << 32) | lo;
+	}
+
+	const bool os_avx    = (xcr0 & 0x06) == 0x06;
+	const bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		features.avx2    = os_avx && (ebx & bit_AVX2) != 0;
+		features.avx512f = os_avx512 && (ebx & bit_AVX512F) != 0;
+		features.sha     = (ebx & bit_SHA) != 0;
+	}
+
+	return features;
+}
+#else
+inline cpu_features detect_cpu_features() {
+	return cpu_features();
+}
+#endif
+
+// CPUID is slow-ish, so we only ever ask once
+inline const cpu_features &cpu() {
+	static const cpu_features features = detect_cpu_features();
+	return features;
+}
+
+}
+}
+
+#endif
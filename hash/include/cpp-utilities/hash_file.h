@@ -0,0 +1,278 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HASH_FILE_20261017_H_
+#define HASH_FILE_20261017_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hash {
+
+struct hash_file_options {
+	// how much is handed to the hasher at a time, and the size of each of the
+	// two read buffers when the file can't be mapped
+	std::size_t chunk_size = 1024 * 1024;
+
+	// map regular files rather than reading them
+	bool use_mmap = true;
+};
+
+template <class Digest>
+struct hash_file_result {
+	Digest digest;
+	uint64_t bytes = 0;
+	double seconds = 0;
+	bool mapped    = false;
+
+	double bytes_per_second() const {
+		return (seconds > 0) ? static_cast<double>(bytes) / seconds : 0;
+	}
+};
+
+namespace detail {
+
+class file_descriptor {
+public:
+	explicit file_descriptor(int fd)
+		: fd_(fd) {
+	}
+
+	file_descriptor(const file_descriptor &)            = delete;
+	file_descriptor &operator=(const file_descriptor &) = delete;
+
+	~file_descriptor() {
+		if (fd_ != -1) {
+			::close(fd_);
+		}
+	}
+
+	int get() const {
+		return fd_;
+	}
+
+private:
+	int fd_;
+};
+
+class mapped_file {
+public:
+	mapped_file(int fd, std::size_t size) {
+		void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			data_ = static_cast<const uint8_t *>(p);
+			size_ = size;
+			::madvise(p, size, MADV_SEQUENTIAL);
+		}
+	}
+
+	mapped_file(const mapped_file &)            = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	~mapped_file() {
+		if (data_) {
+			::munmap(const_cast<uint8_t *>(data_), size_);
+		}
+	}
+
+	const uint8_t *data() const {
+		return data_;
+	}
+
+private:
+	const uint8_t *data_ = nullptr;
+	std::size_t size_    = 0;
+};
+
+template <class Hasher>
+void hash_mapped(Hasher &hasher, const uint8_t *p, std::size_t size, std::size_t chunk_size) {
+	while (size != 0) {
+		const std::size_t n = std::min(size, chunk_size);
+		hasher.update(p, n);
+		p += n;
+		size -= n;
+	}
+}
+
+/*
+ * reads fd to the end on a second thread, into two alternating buffers, so
+ * that the next read is already in flight while a buffer is being hashed.
+ * Returns the number of bytes hashed, throws std::system_error if a read fails
+ */
+template <class Hasher>
+uint64_t hash_streamed(Hasher &hasher, int fd, std::size_t chunk_size) {
+	struct buffer {
+		std::vector<uint8_t> data;
+		std::size_t size = 0;
+		bool full        = false;
+	};
+
+	buffer buffers[2];
+	buffers[0].data.resize(chunk_size);
+	buffers[1].data.resize(chunk_size);
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	int error = 0;
+
+	// an empty buffer marks the end of the data (or an error)
+	std::thread reader([&]() {
+		for (std::size_t i = 0;; i ^= 1) {
+			buffer &b = buffers[i];
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&b]() {
+					return !b.full;
+				});
+			}
+
+			ssize_t n;
+			do {
+				n = ::read(fd, b.data.data(), chunk_size);
+			} while (n == -1 && errno == EINTR);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (n == -1) {
+				error = errno;
+				n     = 0;
+			}
+
+			b.size = static_cast<std::size_t>(n);
+			b.full = true;
+			changed.notify_all();
+
+			if (n == 0) {
+				return;
+			}
+		}
+	});
+
+	uint64_t total = 0;
+	for (std::size_t i = 0;; i ^= 1) {
+		buffer &b = buffers[i];
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&b]() {
+				return b.full;
+			});
+		}
+
+		if (b.size == 0) {
+			break;
+		}
+
+		hasher.update(b.data.data(), b.size);
+		total += b.size;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		b.full = false;
+		changed.notify_all();
+	}
+
+	reader.join();
+
+	if (error != 0) {
+		throw std::system_error(error, std::generic_category(), "read");
+	}
+
+	return total;
+}
+
+}
+
+/**
+ * Hashes everything that can be read from fd, which is left open. Regular
+ * files are mapped (with MADV_SEQUENTIAL, so the kernel reads ahead
+ * aggressively), anything else, or a file which fails to map, is read on a
+ * separate thread with double buffering so that I/O overlaps with hashing.
+ *
+ * Throws std::system_error if the descriptor can't be read.
+ */
+template <class Hasher>
+hash_file_result<typename Hasher::digest> hash_file(int fd, const hash_file_options &options = hash_file_options()) {
+	const auto start             = std::chrono::steady_clock::now();
+	const std::size_t chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+
+	hash_file_result<typename Hasher::digest> result;
+	Hasher hasher;
+
+	struct stat st;
+	if (::fstat(fd, &st) == -1) {
+		throw std::system_error(errno, std::generic_category(), "fstat");
+	}
+
+	bool done = false;
+	if (options.use_mmap && S_ISREG(st.st_mode) && st.st_size > 0 && ::lseek(fd, 0, SEEK_CUR) == 0) {
+		const auto size = static_cast<std::size_t>(st.st_size);
+
+		const detail::mapped_file file(fd, size);
+		if (file.data()) {
+			detail::hash_mapped(hasher, file.data(), size, chunk_size);
+			result.bytes  = size;
+			result.mapped = true;
+			done          = true;
+		}
+	}
+
+	if (!done) {
+		result.bytes = detail::hash_streamed(hasher, fd, chunk_size);
+	}
+
+	result.digest  = hasher.finalize();
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+/**
+ * Hashes the file at path, see hash_file(int, options).
+ *
+ * Throws std::system_error if the file can't be opened or read.
+ */
+template <class Hasher>
+hash_file_result<typename Hasher::digest> hash_file(const std::string &path, const hash_file_options &options = hash_file_options()) {
+	const detail::file_descriptor fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+	if (fd.get() == -1) {
+		throw std::system_error(errno, std::generic_category(), path);
+	}
+
+	return hash_file<Hasher>(fd.get(), options);
+}
+
+}
+
+#endif
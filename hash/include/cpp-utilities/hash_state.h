@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HASH_STATE_20261017_H_
+#define HASH_STATE_20261017_H_
+
+#include <array>
+#include <cpp-utilities/crc32c.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * The checkpoint format shared by the block hashers' export_state() and
+ * import_state(). Every integer is little endian, so a state exported on one
+ * machine can be resumed on any other:
+ *
+ *   offset  size        field
+ *   0       4           algorithm tag ("MD5 ", "SHA1", ...)
+ *   4       1           format version
+ *   5       1           number of bytes buffered in the partial block
+ *   6       2           reserved, zero
+ *   8       8           message length so far, in bits
+ *   16      4 * Words   chaining words
+ *   ...     64          the partial block, zero past the buffered bytes
+ *   ...     4           CRC-32C of everything before it
+ *
+ * Future versions must keep the first 5 bytes where they are, so that a
+ * reader can always tell which format it has been handed.
+ */
+namespace hash {
+namespace detail {
+
+constexpr uint8_t hash_state_version          = 1;
+constexpr std::size_t hash_state_header_size  = 16;
+constexpr std::size_t hash_state_block_size   = 64;
+constexpr std::size_t hash_state_trailer_size = 4;
+
+constexpr std::size_t hash_state_size(std::size_t words) {
+	return hash_state_header_size + 4 * words + hash_state_block_size + hash_state_trailer_size;
+}
+
+inline void store_le(uint8_t *p, uint64_t value, std::size_t bytes) {
+	for (std::size_t i = 0; i < bytes; ++i) {
+		p[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+inline uint64_t load_le(const uint8_t *p, std::size_t bytes) {
+	uint64_t value = 0;
+	for (std::size_t i = 0; i < bytes; ++i) {
+		value |= static_cast<uint64_t>(p[i]) << (8 * i);
+	}
+	return value;
+}
+
+template <std::size_t Words>
+std::array<uint8_t, hash_state_size(Words)> export_hash_state(const char *tag, uint64_t length, std::size_t index, const uint32_t *words, const uint8_t *block) {
+	std::array<uint8_t, hash_state_size(Words)> out = {};
+	uint8_t *p                                       = out.data();
+
+	std::memcpy(p, tag, 4);
+	p[4] = hash_state_version;
+	p[5] = static_cast<uint8_t>(index);
+	store_le(p + 8, length, 8);
+	p += hash_state_header_size;
+
+	for (std::size_t i = 0; i < Words; ++i) {
+		store_le(p, words[i], 4);
+		p += 4;
+	}
+
+	// only the buffered bytes, the rest of the block may be stale
+	std::memcpy(p, block, index);
+	p += hash_state_block_size;
+
+	store_le(p, crc32c().update(out.data(), static_cast<std::size_t>(p - out.data())).finalize().value(), 4);
+	return out;
+}
+
+// returns false, without touching the outputs, if data isn't a valid state for tag
+template <std::size_t Words>
+bool import_hash_state(const char *tag, const void *data, std::size_t size, uint64_t *length, std::size_t *index, uint32_t *words, uint8_t *block) {
+	constexpr std::size_t Size = hash_state_size(Words);
+
+	auto p = static_cast<const uint8_t *>(data);
+
+	if (size != Size || std::memcmp(p, tag, 4) != 0 || p[4] != hash_state_version) {
+		return false;
+	}
+
+	const std::size_t checked = Size - hash_state_trailer_size;
+	if (load_le(p + checked, 4) != crc32c().update(p, checked).finalize().value()) {
+		return false;
+	}
+
+	// the hashers only ever take whole bytes, so the length has to agree with
+	// the number of bytes buffered
+	const std::size_t n = p[5];
+	const uint64_t bits = load_le(p + 8, 8);
+	if (n >= hash_state_block_size || p[6] != 0 || p[7] != 0 || bits % 8 != 0 || (bits / 8) % hash_state_block_size != n) {
+		return false;
+	}
+
+	*length = bits;
+	*index  = n;
+	p += hash_state_header_size;
+
+	for (std::size_t i = 0; i < Words; ++i) {
+		words[i] = static_cast<uint32_t>(load_le(p, 4));
+		p += 4;
+	}
+
+	std::memcpy(block, p, n);
+	return true;
+}
+
+}
+}
+
+#endif
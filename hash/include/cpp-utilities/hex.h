@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HEX_20261017_H_
+#define HEX_20261017_H_
+
+#include <cpp-utilities/hash_detail.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace hash {
+namespace detail {
+
+#ifdef HASH_X86_64_DISPATCH
+// 16 bytes -> 32 lower case hex characters. SSE2 is part of the x86-64
+// baseline so unlike the other kernels this one needs no runtime check
+inline void hex_encode_16(const uint8_t *p, char *out) {
+	const __m128i mask  = _mm_set1_epi8(0x0f);
+	const __m128i nine  = _mm_set1_epi8(9);
+	const __m128i digit = _mm_set1_epi8('0');
+	const __m128i alpha = _mm_set1_epi8('a' - '0' - 10);
+
+	const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+	const __m128i lo = _mm_and_si128(v, mask);
+
+	// interleave so each byte's high nibble comes first
+	__m128i first  = _mm_unpacklo_epi8(hi, lo);
+	__m128i second = _mm_unpackhi_epi8(hi, lo);
+
+	// '0' + n, plus the distance from '9' + 1 to 'a' for n > 9
+	first  = _mm_add_epi8(_mm_add_epi8(first, digit), _mm_and_si128(_mm_cmpgt_epi8(first, nine), alpha));
+	second = _mm_add_epi8(_mm_add_epi8(second, digit), _mm_and_si128(_mm_cmpgt_epi8(second, nine), alpha));
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out), first);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), second);
+}
+#endif
+
+/*
+ * writes the 2 * n lower case hex characters for [p, p + n) to out, most
+ * significant nibble of each byte first. No terminator is written.
+ */
+inline void hex_encode(const uint8_t *p, std::size_t n, char *out) {
+	static const char hexchars[] = "0123456789abcdef";
+
+#ifdef HASH_X86_64_DISPATCH
+	if (n >= 16) {
+		const uint8_t *const end = p + n;
+		char *const out_end      = out + 2 * n;
+
+		while (end - p >= 16) {
+			hex_encode_16(p, out);
+			p += 16;
+			out += 32;
+		}
+
+		// finish with an overlapping block rather than a scalar loop
+		if (p != end) {
+			hex_encode_16(end - 16, out_end - 32);
+		}
+		return;
+	}
+#endif
+
+	for (std::size_t i = 0; i < n; ++i) {
+		*out++ = hexchars[p[i] >> 4];
+		*out++ = hexchars[p[i] & 0x0f];
+	}
+}
+
+// the hex of an integer digest, most significant byte first
+template <std::size_t Bytes, class T>
+void hex_encode_value(T value, char *out) {
+	uint8_t b[Bytes];
+	for (std::size_t i = 0; i < Bytes; ++i) {
+		b[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * (Bytes - 1 - i)));
+	}
+	hex_encode(b, Bytes, out);
+}
+
+}
+
+/**
+ * Writes the hex form of every digest in [first, last) to [out, out_last),
+ * back to back, each followed by separator if one is given. Returns one
+ * past the last character written, or nullptr (having written nothing) if
+ * the output is too small. No terminator is written.
+ */
+template <class Digest>
+char *to_chars(const Digest *first, const Digest *last, char *out, char *out_last) {
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	if (static_cast<std::size_t>(out_last - out) < count * Digest::HexSize) {
+		return nullptr;
+	}
+
+	for (; first != last; ++first) {
+		out = first->to_chars(out, out_last);
+	}
+
+	return out;
+}
+
+template <class Digest>
+char *to_chars(const Digest *first, const Digest *last, char *out, char *out_last, char separator) {
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	if (static_cast<std::size_t>(out_last - out) < count * (Digest::HexSize + 1)) {
+		return nullptr;
+	}
+
+	for (; first != last; ++first) {
+		out    = first->to_chars(out, out_last);
+		*out++ = separator;
+	}
+
+	return out;
+}
+
+}
+
+#endif
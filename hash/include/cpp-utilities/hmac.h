@@ -0,0 +1,161 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HMAC_20261017_H_
+#define HMAC_20261017_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace hash {
+
+/**
+ * HMAC (RFC 2104) over any of the 64 byte block hashers, e.g.
+ * hash::hmac<hash::sha1>. The key is absorbed once, when the hmac is
+ * constructed: the hasher states after the inner (key ^ ipad) and outer
+ * (key ^ opad) blocks are kept, so each message only costs its own blocks
+ * plus the two finalizations, instead of two extra key blocks as well.
+ *
+ * Like the hashers, data can be streamed in with update() and finalize()
+ * doesn't modify the state. clear() starts a new message with the same key.
+ * sign() is a convenience for one-shot messages which leaves the streaming
+ * state alone, so a single hmac can be shared between threads for that.
+ */
+template <class Hasher>
+class hmac {
+public:
+	using digest = typename Hasher::digest;
+
+	static constexpr std::size_t BlockSize = Hasher::state::BlockSize;
+
+public:
+	hmac(const void *key, std::size_t size) {
+		uint8_t block[BlockSize] = {};
+
+		// keys longer than a block are replaced by their hash
+		if (size > BlockSize) {
+			const auto b = Hasher().update(key, size).finalize().bytes();
+			std::memcpy(block, b.data(), b.size());
+		} else if (size != 0) {
+			std::memcpy(block, key, size);
+		}
+
+		uint8_t pad[BlockSize];
+		for (std::size_t i = 0; i < BlockSize; ++i) {
+			pad[i] = block[i] ^ 0x36;
+		}
+		inner_.update(pad, BlockSize);
+
+		for (std::size_t i = 0; i < BlockSize; ++i) {
+			pad[i] = block[i] ^ 0x5c;
+		}
+		outer_.update(pad, BlockSize);
+
+		current_ = inner_;
+	}
+
+	explicit hmac(const std::string &key)
+		: hmac(key.data(), key.size()) {
+	}
+
+	hmac(const hmac &other)            = default;
+	hmac &operator=(const hmac &other) = default;
+
+public:
+	hmac &update(const void *data, std::size_t size) {
+		current_.update(data, size);
+		return *this;
+	}
+
+	hmac &update(const std::string &s) {
+		current_.update(s);
+		return *this;
+	}
+
+	template <class In>
+	hmac &update(In first, In last) {
+		current_.update(first, last);
+		return *this;
+	}
+
+	hmac &update(uint8_t byte) {
+		current_.update(byte);
+		return *this;
+	}
+
+	digest finalize() const {
+		return finish(current_);
+	}
+
+	void clear() {
+		current_ = inner_;
+	}
+
+public:
+	digest sign(const void *data, std::size_t size) const {
+		Hasher h = inner_;
+		h.update(data, size);
+		return finish(h);
+	}
+
+	digest sign(const std::string &message) const {
+		return sign(message.data(), message.size());
+	}
+
+	// compares in constant time, so a forger can't learn how much of a guess was right
+	bool verify(const void *data, std::size_t size, const digest &mac) const {
+		const auto expected = sign(data, size).bytes();
+		const auto actual   = mac.bytes();
+
+		uint8_t difference = 0;
+		for (std::size_t i = 0; i < expected.size(); ++i) {
+			difference |= expected[i] ^ actual[i];
+		}
+		return difference == 0;
+	}
+
+	bool verify(const std::string &message, const digest &mac) const {
+		return verify(message.data(), message.size(), mac);
+	}
+
+private:
+	digest finish(const Hasher &inner) const {
+		const auto b = inner.finalize().bytes();
+
+		Hasher h = outer_;
+		h.update(b.data(), b.size());
+		return h.finalize();
+	}
+
+private:
+	Hasher inner_;
+	Hasher outer_;
+	Hasher current_;
+};
+
+}
+
+#endif
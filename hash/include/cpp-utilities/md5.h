@@ -29,6 +29,9 @@
 #include <array>
 #include <climits>
 #include <cpp-utilities/bitwise.h>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hash_state.h>
+#include <cpp-utilities/hex.h>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -38,6 +41,8 @@ namespace hash {
 
 namespace detail {
 
+struct md5_lanes;
+
 constexpr uint32_t F(uint32_t x, uint32_t y, uint32_t z) {
 	return (x & y) | (~x & z);
 }
@@ -55,50 +60,69 @@ constexpr uint32_t I(uint32_t x, uint32_t y, uint32_t z) {
 }
 
 template <class Func>
-uint32_t xfrm(Func f, uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
-	a += f(b, c, d) + x + ac;
-	a = bitwise::rotate_left(a, s) + b;
-	return a;
+constexpr uint32_t xfrm(Func f, uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
+	return bitwise::rotate_left(a + f(b, c, d) + x + ac, static_cast<int>(s)) + b;
+}
+
+constexpr uint32_t FF(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
+	return xfrm(F, a, b, c, d, x, s, ac);
+}
+
+constexpr uint32_t GG(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
+	return xfrm(G, a, b, c, d, x, s, ac);
+}
+
+constexpr uint32_t HH(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
+	return xfrm(H, a, b, c, d, x, s, ac);
+}
+
+constexpr uint32_t II(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
+	return xfrm(I, a, b, c, d, x, s, ac);
 }
 
 }
 
-class md5 {
+class md5 : public detail::string_updates<md5> {
+	friend struct detail::md5_lanes;
+
 public:
 	struct state {
 		static constexpr int BlockSize = 64;
 
-		uint8_t block_[BlockSize]; // input buffer
+		uint8_t block_[BlockSize] = {}; // input buffer
 		uint64_t length_ = 0;      // number of bits
 		size_t index_    = 0;
 	};
 
 	class digest {
 		friend class md5;
+		friend struct detail::md5_lanes;
 
 	public:
-		std::string to_string() const {
-			static const char hexchars[] = "0123456789abcdef";
-
-			std::string str;
-			str.reserve(32);
+		static constexpr std::size_t HexSize = 32;
 
-			auto p = std::back_inserter(str);
-
-			for (int i = 0; i < 4; ++i) {
-				*p++ = hexchars[(h_[i] & 0x000000f0) >> 0x04];
-				*p++ = hexchars[(h_[i] & 0x0000000f) >> 0x00];
-				*p++ = hexchars[(h_[i] & 0x0000f000) >> 0x0c];
-				*p++ = hexchars[(h_[i] & 0x00000f00) >> 0x08];
-				*p++ = hexchars[(h_[i] & 0x00f00000) >> 0x14];
-				*p++ = hexchars[(h_[i] & 0x000f0000) >> 0x10];
-				*p++ = hexchars[(h_[i] & 0xf0000000) >> 0x1c];
-				*p++ = hexchars[(h_[i] & 0x0f000000) >> 0x18];
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
 			}
 
+			const auto b = bytes();
+			detail::hex_encode(b.data(), b.size(), first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
 			return str;
 		}
 
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
 		std::array<uint8_t, 16> bytes() const {
 			std::array<uint8_t, 16> b;
 
@@ -112,11 +136,16 @@ public:
 			return b;
 		}
 
-		bool operator==(const digest &rhs) const {
-			return std::memcmp(h_, rhs.h_, sizeof(h_)) == 0;
+		HASH_CONSTEXPR14 bool operator==(const digest &rhs) const {
+			for (int i = 0; i < 4; ++i) {
+				if (h_[i] != rhs.h_[i]) {
+					return false;
+				}
+			}
+			return true;
 		}
 
-		bool operator!=(const digest &rhs) const {
+		HASH_CONSTEXPR14 bool operator!=(const digest &rhs) const {
 			return !(*this == rhs);
 		}
 
@@ -139,6 +168,18 @@ public:
 		update(s);
 	}
 
+	template <class Char, std::size_t N, class = detail::if_string_literal<Char>>
+	HASH_CONSTEXPR14 md5(Char (&s)[N]) {
+		update(s);
+	}
+
+#if __cplusplus >= 201703L
+	template <class View, class = detail::if_string_view<View>>
+	HASH_CONSTEXPR14 md5(View s) {
+		update(s);
+	}
+#endif
+
 	md5()                          = default;
 	md5(const md5 &other)          = default;
 	md5 &operator=(const md5 &rhs) = default;
@@ -146,13 +187,11 @@ public:
 public:
 	template <class In>
 	md5 &update(In first, In last) {
-		while (first != last) {
-			update(*first++);
-		}
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
 		return *this;
 	}
 
-	md5 &update(uint8_t byte) {
+	HASH_CONSTEXPR14 md5 &update(uint8_t byte) {
 		state_.block_[state_.index_++] = byte;
 
 		state_.length_ += 8;
@@ -164,7 +203,41 @@ public:
 	}
 
 	md5 &update(const std::string &s) {
-		update(s.begin(), s.end());
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	using detail::string_updates<md5>::update;
+
+	md5 &update(const void *data, std::size_t size) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		state_.length_ += static_cast<uint64_t>(size) * 8;
+
+		// top up any partially filled block first
+		if (state_.index_ != 0) {
+			const std::size_t n = std::min<std::size_t>(size, state::BlockSize - state_.index_);
+			std::memcpy(&state_.block_[state_.index_], p, n);
+			state_.index_ += n;
+			p += n;
+			size -= n;
+
+			if (state_.index_ == state::BlockSize) {
+				process_block(&state_, &digest_);
+			}
+		}
+
+		// whole blocks can be transformed straight out of the caller's buffer
+		const std::size_t blocks = size / state::BlockSize;
+		if (blocks != 0) {
+			process_blocks(p, blocks, &digest_);
+			p += blocks * state::BlockSize;
+			size -= blocks * state::BlockSize;
+		}
+
+		// and only the tail needs to be buffered
+		std::memcpy(&state_.block_[state_.index_], p, size);
+		state_.index_ += size;
 		return *this;
 	}
 
@@ -181,7 +254,32 @@ public:
 		state_  = state();
 	}
 
-	digest finalize() const {
+	static constexpr std::size_t StateSize = detail::hash_state_size(4);
+
+	/**
+	 * Checkpoints the hash of everything seen so far. Passing the result to
+	 * import_state (in this process or another) resumes hashing where it left
+	 * off, without having to feed the prefix through again. The format is
+	 * versioned and byte order independent, see hash_state.h
+	 */
+	std::array<uint8_t, StateSize> export_state() const {
+		return detail::export_hash_state<4>("MD5 ", state_.length_, state_.index_, digest_.h_, state_.block_);
+	}
+
+	// returns false, leaving the hasher unchanged, if data isn't a valid MD5 state
+	bool import_state(const void *data, std::size_t size) {
+		state s;
+		digest d;
+		if (!detail::import_hash_state<4>("MD5 ", data, size, &s.length_, &s.index_, d.h_, s.block_)) {
+			return false;
+		}
+
+		state_  = s;
+		digest_ = d;
+		return true;
+	}
+
+	HASH_CONSTEXPR14 digest finalize() const {
 		// make copies so this isn't a mutating operation
 		state s  = state_;
 		digest d = digest_;
@@ -217,126 +315,143 @@ public:
 	}
 
 private:
-	static void process_block(state *state, digest *digest) {
-		auto FF = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
-			return detail::xfrm(detail::F, a, b, c, d, x, s, ac);
-		};
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
 
-		auto GG = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
-			return detail::xfrm(detail::G, a, b, c, d, x, s, ac);
-		};
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(*first++);
+		}
+	}
 
-		auto HH = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
-			return detail::xfrm(detail::H, a, b, c, d, x, s, ac);
-		};
+	static HASH_CONSTEXPR14 void process_block(state *state, digest *digest) {
+		if (detail::in_constant_evaluation()) {
+			transform(state->block_, digest);
+		} else {
+			process_blocks(state->block_, 1, digest);
+		}
+		state->index_ = 0;
+	}
 
-		auto II = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t x, uint32_t s, uint32_t ac) {
-			return detail::xfrm(detail::I, a, b, c, d, x, s, ac);
-		};
+	static void process_blocks(const uint8_t *block, std::size_t count, digest *digest) {
+		while (count--) {
+			transform(block, digest);
+			block += state::BlockSize;
+		}
+	}
 
-		static constexpr int S11 = 7;
-		static constexpr int S12 = 12;
-		static constexpr int S13 = 17;
-		static constexpr int S14 = 22;
-		static constexpr int S21 = 5;
-		static constexpr int S22 = 9;
-		static constexpr int S23 = 14;
-		static constexpr int S24 = 20;
-		static constexpr int S31 = 4;
-		static constexpr int S32 = 11;
-		static constexpr int S33 = 16;
-		static constexpr int S34 = 23;
-		static constexpr int S41 = 6;
-		static constexpr int S42 = 10;
-		static constexpr int S43 = 15;
-		static constexpr int S44 = 21;
+	static HASH_CONSTEXPR14 void transform(const uint8_t *block, digest *digest) {
+		constexpr int S11 = 7;
+		constexpr int S12 = 12;
+		constexpr int S13 = 17;
+		constexpr int S14 = 22;
+		constexpr int S21 = 5;
+		constexpr int S22 = 9;
+		constexpr int S23 = 14;
+		constexpr int S24 = 20;
+		constexpr int S31 = 4;
+		constexpr int S32 = 11;
+		constexpr int S33 = 16;
+		constexpr int S34 = 23;
+		constexpr int S41 = 6;
+		constexpr int S42 = 10;
+		constexpr int S43 = 15;
+		constexpr int S44 = 21;
 
 		uint32_t a = digest->h_[0];
 		uint32_t b = digest->h_[1];
 		uint32_t c = digest->h_[2];
 		uint32_t d = digest->h_[3];
 
-		uint32_t x[16];
-		std::memcpy(x, state->block_, sizeof(x));
+		uint32_t x[16] = {};
+		for (int i = 0; i < 16; ++i) {
+			x[i] = static_cast<uint32_t>(block[i * 4 + 0]) |
+				   (static_cast<uint32_t>(block[i * 4 + 1]) << 8) |
+				   (static_cast<uint32_t>(block[i * 4 + 2]) << 16) |
+				   (static_cast<uint32_t>(block[i * 4 + 3]) << 24);
+		}
 
 		/* Round 1 */
-		a = FF(a, b, c, d, x[0], S11, 0xd76aa478);  /* 1 */
-		d = FF(d, a, b, c, x[1], S12, 0xe8c7b756);  /* 2 */
-		c = FF(c, d, a, b, x[2], S13, 0x242070db);  /* 3 */
-		b = FF(b, c, d, a, x[3], S14, 0xc1bdceee);  /* 4 */
-		a = FF(a, b, c, d, x[4], S11, 0xf57c0faf);  /* 5 */
-		d = FF(d, a, b, c, x[5], S12, 0x4787c62a);  /* 6 */
-		c = FF(c, d, a, b, x[6], S13, 0xa8304613);  /* 7 */
-		b = FF(b, c, d, a, x[7], S14, 0xfd469501);  /* 8 */
-		a = FF(a, b, c, d, x[8], S11, 0x698098d8);  /* 9 */
-		d = FF(d, a, b, c, x[9], S12, 0x8b44f7af);  /* 10 */
-		c = FF(c, d, a, b, x[10], S13, 0xffff5bb1); /* 11 */
-		b = FF(b, c, d, a, x[11], S14, 0x895cd7be); /* 12 */
-		a = FF(a, b, c, d, x[12], S11, 0x6b901122); /* 13 */
-		d = FF(d, a, b, c, x[13], S12, 0xfd987193); /* 14 */
-		c = FF(c, d, a, b, x[14], S13, 0xa679438e); /* 15 */
-		b = FF(b, c, d, a, x[15], S14, 0x49b40821); /* 16 */
+		a = detail::FF(a, b, c, d, x[0], S11, 0xd76aa478);  /* 1 */
+		d = detail::FF(d, a, b, c, x[1], S12, 0xe8c7b756);  /* 2 */
+		c = detail::FF(c, d, a, b, x[2], S13, 0x242070db);  /* 3 */
+		b = detail::FF(b, c, d, a, x[3], S14, 0xc1bdceee);  /* 4 */
+		a = detail::FF(a, b, c, d, x[4], S11, 0xf57c0faf);  /* 5 */
+		d = detail::FF(d, a, b, c, x[5], S12, 0x4787c62a);  /* 6 */
+		c = detail::FF(c, d, a, b, x[6], S13, 0xa8304613);  /* 7 */
+		b = detail::FF(b, c, d, a, x[7], S14, 0xfd469501);  /* 8 */
+		a = detail::FF(a, b, c, d, x[8], S11, 0x698098d8);  /* 9 */
+		d = detail::FF(d, a, b, c, x[9], S12, 0x8b44f7af);  /* 10 */
+		c = detail::FF(c, d, a, b, x[10], S13, 0xffff5bb1); /* 11 */
+		b = detail::FF(b, c, d, a, x[11], S14, 0x895cd7be); /* 12 */
+		a = detail::FF(a, b, c, d, x[12], S11, 0x6b901122); /* 13 */
+		d = detail::FF(d, a, b, c, x[13], S12, 0xfd987193); /* 14 */
+		c = detail::FF(c, d, a, b, x[14], S13, 0xa679438e); /* 15 */
+		b = detail::FF(b, c, d, a, x[15], S14, 0x49b40821); /* 16 */
 
 		/* Round 2 */
-		a = GG(a, b, c, d, x[1], S21, 0xf61e2562);  /* 17 */
-		d = GG(d, a, b, c, x[6], S22, 0xc040b340);  /* 18 */
-		c = GG(c, d, a, b, x[11], S23, 0x265e5a51); /* 19 */
-		b = GG(b, c, d, a, x[0], S24, 0xe9b6c7aa);  /* 20 */
-		a = GG(a, b, c, d, x[5], S21, 0xd62f105d);  /* 21 */
-		d = GG(d, a, b, c, x[10], S22, 0x02441453); /* 22 */
-		c = GG(c, d, a, b, x[15], S23, 0xd8a1e681); /* 23 */
-		b = GG(b, c, d, a, x[4], S24, 0xe7d3fbc8);  /* 24 */
-		a = GG(a, b, c, d, x[9], S21, 0x21e1cde6);  /* 25 */
-		d = GG(d, a, b, c, x[14], S22, 0xc33707d6); /* 26 */
-		c = GG(c, d, a, b, x[3], S23, 0xf4d50d87);  /* 27 */
-		b = GG(b, c, d, a, x[8], S24, 0x455a14ed);  /* 28 */
-		a = GG(a, b, c, d, x[13], S21, 0xa9e3e905); /* 29 */
-		d = GG(d, a, b, c, x[2], S22, 0xfcefa3f8);  /* 30 */
-		c = GG(c, d, a, b, x[7], S23, 0x676f02d9);  /* 31 */
-		b = GG(b, c, d, a, x[12], S24, 0x8d2a4c8a); /* 32 */
+		a = detail::GG(a, b, c, d, x[1], S21, 0xf61e2562);  /* 17 */
+		d = detail::GG(d, a, b, c, x[6], S22, 0xc040b340);  /* 18 */
+		c = detail::GG(c, d, a, b, x[11], S23, 0x265e5a51); /* 19 */
+		b = detail::GG(b, c, d, a, x[0], S24, 0xe9b6c7aa);  /* 20 */
+		a = detail::GG(a, b, c, d, x[5], S21, 0xd62f105d);  /* 21 */
+		d = detail::GG(d, a, b, c, x[10], S22, 0x02441453); /* 22 */
+		c = detail::GG(c, d, a, b, x[15], S23, 0xd8a1e681); /* 23 */
+		b = detail::GG(b, c, d, a, x[4], S24, 0xe7d3fbc8);  /* 24 */
+		a = detail::GG(a, b, c, d, x[9], S21, 0x21e1cde6);  /* 25 */
+		d = detail::GG(d, a, b, c, x[14], S22, 0xc33707d6); /* 26 */
+		c = detail::GG(c, d, a, b, x[3], S23, 0xf4d50d87);  /* 27 */
+		b = detail::GG(b, c, d, a, x[8], S24, 0x455a14ed);  /* 28 */
+		a = detail::GG(a, b, c, d, x[13], S21, 0xa9e3e905); /* 29 */
+		d = detail::GG(d, a, b, c, x[2], S22, 0xfcefa3f8);  /* 30 */
+		c = detail::GG(c, d, a, b, x[7], S23, 0x676f02d9);  /* 31 */
+		b = detail::GG(b, c, d, a, x[12], S24, 0x8d2a4c8a); /* 32 */
 
 		/* Round 3 */
-		a = HH(a, b, c, d, x[5], S31, 0xfffa3942);  /* 33 */
-		d = HH(d, a, b, c, x[8], S32, 0x8771f681);  /* 34 */
-		c = HH(c, d, a, b, x[11], S33, 0x6d9d6122); /* 35 */
-		b = HH(b, c, d, a, x[14], S34, 0xfde5380c); /* 36 */
-		a = HH(a, b, c, d, x[1], S31, 0xa4beea44);  /* 37 */
-		d = HH(d, a, b, c, x[4], S32, 0x4bdecfa9);  /* 38 */
-		c = HH(c, d, a, b, x[7], S33, 0xf6bb4b60);  /* 39 */
-		b = HH(b, c, d, a, x[10], S34, 0xbebfbc70); /* 40 */
-		a = HH(a, b, c, d, x[13], S31, 0x289b7ec6); /* 41 */
-		d = HH(d, a, b, c, x[0], S32, 0xeaa127fa);  /* 42 */
-		c = HH(c, d, a, b, x[3], S33, 0xd4ef3085);  /* 43 */
-		b = HH(b, c, d, a, x[6], S34, 0x04881d05);  /* 44 */
-		a = HH(a, b, c, d, x[9], S31, 0xd9d4d039);  /* 45 */
-		d = HH(d, a, b, c, x[12], S32, 0xe6db99e5); /* 46 */
-		c = HH(c, d, a, b, x[15], S33, 0x1fa27cf8); /* 47 */
-		b = HH(b, c, d, a, x[2], S34, 0xc4ac5665);  /* 48 */
+		a = detail::HH(a, b, c, d, x[5], S31, 0xfffa3942);  /* 33 */
+		d = detail::HH(d, a, b, c, x[8], S32, 0x8771f681);  /* 34 */
+		c = detail::HH(c, d, a, b, x[11], S33, 0x6d9d6122); /* 35 */
+		b = detail::HH(b, c, d, a, x[14], S34, 0xfde5380c); /* 36 */
+		a = detail::HH(a, b, c, d, x[1], S31, 0xa4beea44);  /* 37 */
+		d = detail::HH(d, a, b, c, x[4], S32, 0x4bdecfa9);  /* 38 */
+		c = detail::HH(c, d, a, b, x[7], S33, 0xf6bb4b60);  /* 39 */
+		b = detail::HH(b, c, d, a, x[10], S34, 0xbebfbc70); /* 40 */
+		a = detail::HH(a, b, c, d, x[13], S31, 0x289b7ec6); /* 41 */
+		d = detail::HH(d, a, b, c, x[0], S32, 0xeaa127fa);  /* 42 */
+		c = detail::HH(c, d, a, b, x[3], S33, 0xd4ef3085);  /* 43 */
+		b = detail::HH(b, c, d, a, x[6], S34, 0x04881d05);  /* 44 */
+		a = detail::HH(a, b, c, d, x[9], S31, 0xd9d4d039);  /* 45 */
+		d = detail::HH(d, a, b, c, x[12], S32, 0xe6db99e5); /* 46 */
+		c = detail::HH(c, d, a, b, x[15], S33, 0x1fa27cf8); /* 47 */
+		b = detail::HH(b, c, d, a, x[2], S34, 0xc4ac5665);  /* 48 */
 
 		/* Round 4 */
-		a = II(a, b, c, d, x[0], S41, 0xf4292244);  /* 49 */
-		d = II(d, a, b, c, x[7], S42, 0x432aff97);  /* 50 */
-		c = II(c, d, a, b, x[14], S43, 0xab9423a7); /* 51 */
-		b = II(b, c, d, a, x[5], S44, 0xfc93a039);  /* 52 */
-		a = II(a, b, c, d, x[12], S41, 0x655b59c3); /* 53 */
-		d = II(d, a, b, c, x[3], S42, 0x8f0ccc92);  /* 54 */
-		c = II(c, d, a, b, x[10], S43, 0xffeff47d); /* 55 */
-		b = II(b, c, d, a, x[1], S44, 0x85845dd1);  /* 56 */
-		a = II(a, b, c, d, x[8], S41, 0x6fa87e4f);  /* 57 */
-		d = II(d, a, b, c, x[15], S42, 0xfe2ce6e0); /* 58 */
-		c = II(c, d, a, b, x[6], S43, 0xa3014314);  /* 59 */
-		b = II(b, c, d, a, x[13], S44, 0x4e0811a1); /* 60 */
-		a = II(a, b, c, d, x[4], S41, 0xf7537e82);  /* 61 */
-		d = II(d, a, b, c, x[11], S42, 0xbd3af235); /* 62 */
-		c = II(c, d, a, b, x[2], S43, 0x2ad7d2bb);  /* 63 */
-		b = II(b, c, d, a, x[9], S44, 0xeb86d391);  /* 64 */
+		a = detail::II(a, b, c, d, x[0], S41, 0xf4292244);  /* 49 */
+		d = detail::II(d, a, b, c, x[7], S42, 0x432aff97);  /* 50 */
+		c = detail::II(c, d, a, b, x[14], S43, 0xab9423a7); /* 51 */
+		b = detail::II(b, c, d, a, x[5], S44, 0xfc93a039);  /* 52 */
+		a = detail::II(a, b, c, d, x[12], S41, 0x655b59c3); /* 53 */
+		d = detail::II(d, a, b, c, x[3], S42, 0x8f0ccc92);  /* 54 */
+		c = detail::II(c, d, a, b, x[10], S43, 0xffeff47d); /* 55 */
+		b = detail::II(b, c, d, a, x[1], S44, 0x85845dd1);  /* 56 */
+		a = detail::II(a, b, c, d, x[8], S41, 0x6fa87e4f);  /* 57 */
+		d = detail::II(d, a, b, c, x[15], S42, 0xfe2ce6e0); /* 58 */
+		c = detail::II(c, d, a, b, x[6], S43, 0xa3014314);  /* 59 */
+		b = detail::II(b, c, d, a, x[13], S44, 0x4e0811a1); /* 60 */
+		a = detail::II(a, b, c, d, x[4], S41, 0xf7537e82);  /* 61 */
+		d = detail::II(d, a, b, c, x[11], S42, 0xbd3af235); /* 62 */
+		c = detail::II(c, d, a, b, x[2], S43, 0x2ad7d2bb);  /* 63 */
+		b = detail::II(b, c, d, a, x[9], S44, 0xeb86d391);  /* 64 */
 
 		digest->h_[0] += a;
 		digest->h_[1] += b;
 		digest->h_[2] += c;
 		digest->h_[3] += d;
-
-		state->index_ = 0;
 	}
 
 private:
@@ -0,0 +1,220 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MD5_BATCH_20261017_H_
+#define MD5_BATCH_20261017_H_
+
+#include <array>
+#include <cpp-utilities/md5.h>
+#include <cpp-utilities/multi_buffer.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hash {
+
+namespace detail {
+
+struct md5_lanes {
+	using digest = md5::digest;
+
+	static constexpr std::size_t Words = 4;
+	static constexpr bool BigEndian    = false;
+
+	static const uint32_t *iv() {
+		static const digest d;
+		return d.h_;
+	}
+
+	static void load(const uint32_t *words, digest *d) {
+		std::copy(words, words + Words, d->h_);
+	}
+
+	static void process(digest *d, const uint8_t *blocks, std::size_t count) {
+		md5::process_blocks(blocks, count, d);
+	}
+
+	static bool prefer_scalar() {
+		return false;
+	}
+
+#ifdef HASH_VECTOR_EXTENSIONS
+	// a = b + ((a + f + x + k) <<< S)
+	template <int S, class V>
+	static HASH_ALWAYS_INLINE void step(V &a, const V &b, const V &f, const V &x, uint32_t k) {
+		const V t = a + f + x + k;
+		a         = ((t << S) | (t >> (32 - S))) + b;
+	}
+
+	template <class V>
+	static HASH_ALWAYS_INLINE void compress(V *state, const uint8_t *const *blocks) {
+		V x[16];
+		for (std::size_t i = 0; i < 16; ++i) {
+			gather_word(x[i], blocks, i, false);
+		}
+
+		V a = state[0];
+		V b = state[1];
+		V c = state[2];
+		V d = state[3];
+
+#define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+		/* Round 1 */
+		step<7>(a, b, MD5_F(b, c, d), x[0], 0xd76aa478);
+		step<12>(d, a, MD5_F(a, b, c), x[1], 0xe8c7b756);
+		step<17>(c, d, MD5_F(d, a, b), x[2], 0x242070db);
+		step<22>(b, c, MD5_F(c, d, a), x[3], 0xc1bdceee);
+		step<7>(a, b, MD5_F(b, c, d), x[4], 0xf57c0faf);
+		step<12>(d, a, MD5_F(a, b, c), x[5], 0x4787c62a);
+		step<17>(c, d, MD5_F(d, a, b), x[6], 0xa8304613);
+		step<22>(b, c, MD5_F(c, d, a), x[7], 0xfd469501);
+		step<7>(a, b, MD5_F(b, c, d), x[8], 0x698098d8);
+		step<12>(d, a, MD5_F(a, b, c), x[9], 0x8b44f7af);
+		step<17>(c, d, MD5_F(d, a, b), x[10], 0xffff5bb1);
+		step<22>(b, c, MD5_F(c, d, a), x[11], 0x895cd7be);
+		step<7>(a, b, MD5_F(b, c, d), x[12], 0x6b901122);
+		step<12>(d, a, MD5_F(a, b, c), x[13], 0xfd987193);
+		step<17>(c, d, MD5_F(d, a, b), x[14], 0xa679438e);
+		step<22>(b, c, MD5_F(c, d, a), x[15], 0x49b40821);
+
+		/* Round 2 */
+		step<5>(a, b, MD5_G(b, c, d), x[1], 0xf61e2562);
+		step<9>(d, a, MD5_G(a, b, c), x[6], 0xc040b340);
+		step<14>(c, d, MD5_G(d, a, b), x[11], 0x265e5a51);
+		step<20>(b, c, MD5_G(c, d, a), x[0], 0xe9b6c7aa);
+		step<5>(a, b, MD5_G(b, c, d), x[5], 0xd62f105d);
+		step<9>(d, a, MD5_G(a, b, c), x[10], 0x02441453);
+		step<14>(c, d, MD5_G(d, a, b), x[15], 0xd8a1e681);
+		step<20>(b, c, MD5_G(c, d, a), x[4], 0xe7d3fbc8);
+		step<5>(a, b, MD5_G(b, c, d), x[9], 0x21e1cde6);
+		step<9>(d, a, MD5_G(a, b, c), x[14], 0xc33707d6);
+		step<14>(c, d, MD5_G(d, a, b), x[3], 0xf4d50d87);
+		step<20>(b, c, MD5_G(c, d, a), x[8], 0x455a14ed);
+		step<5>(a, b, MD5_G(b, c, d), x[13], 0xa9e3e905);
+		step<9>(d, a, MD5_G(a, b, c), x[2], 0xfcefa3f8);
+		step<14>(c, d, MD5_G(d, a, b), x[7], 0x676f02d9);
+		step<20>(b, c, MD5_G(c, d, a), x[12], 0x8d2a4c8a);
+
+		/* Round 3 */
+		step<4>(a, b, MD5_H(b, c, d), x[5], 0xfffa3942);
+		step<11>(d, a, MD5_H(a, b, c), x[8], 0x8771f681);
+		step<16>(c, d, MD5_H(d, a, b), x[11], 0x6d9d6122);
+		step<23>(b, c, MD5_H(c, d, a), x[14], 0xfde5380c);
+		step<4>(a, b, MD5_H(b, c, d), x[1], 0xa4beea44);
+		step<11>(d, a, MD5_H(a, b, c), x[4], 0x4bdecfa9);
+		step<16>(c, d, MD5_H(d, a, b), x[7], 0xf6bb4b60);
+		step<23>(b, c, MD5_H(c, d, a), x[10], 0xbebfbc70);
+		step<4>(a, b, MD5_H(b, c, d), x[13], 0x289b7ec6);
+		step<11>(d, a, MD5_H(a, b, c), x[0], 0xeaa127fa);
+		step<16>(c, d, MD5_H(d, a, b), x[3], 0xd4ef3085);
+		step<23>(b, c, MD5_H(c, d, a), x[6], 0x04881d05);
+		step<4>(a, b, MD5_H(b, c, d), x[9], 0xd9d4d039);
+		step<11>(d, a, MD5_H(a, b, c), x[12], 0xe6db99e5);
+		step<16>(c, d, MD5_H(d, a, b), x[15], 0x1fa27cf8);
+		step<23>(b, c, MD5_H(c, d, a), x[2], 0xc4ac5665);
+
+		/* Round 4 */
+		step<6>(a, b, MD5_I(b, c, d), x[0], 0xf4292244);
+		step<10>(d, a, MD5_I(a, b, c), x[7], 0x432aff97);
+		step<15>(c, d, MD5_I(d, a, b), x[14], 0xab9423a7);
+		step<21>(b, c, MD5_I(c, d, a), x[5], 0xfc93a039);
+		step<6>(a, b, MD5_I(b, c, d), x[12], 0x655b59c3);
+		step<10>(d, a, MD5_I(a, b, c), x[3], 0x8f0ccc92);
+		step<15>(c, d, MD5_I(d, a, b), x[10], 0xffeff47d);
+		step<21>(b, c, MD5_I(c, d, a), x[1], 0x85845dd1);
+		step<6>(a, b, MD5_I(b, c, d), x[8], 0x6fa87e4f);
+		step<10>(d, a, MD5_I(a, b, c), x[15], 0xfe2ce6e0);
+		step<15>(c, d, MD5_I(d, a, b), x[6], 0xa3014314);
+		step<21>(b, c, MD5_I(c, d, a), x[13], 0x4e0811a1);
+		step<6>(a, b, MD5_I(b, c, d), x[4], 0xf7537e82);
+		step<10>(d, a, MD5_I(a, b, c), x[11], 0xbd3af235);
+		step<15>(c, d, MD5_I(d, a, b), x[2], 0x2ad7d2bb);
+		step<21>(b, c, MD5_I(c, d, a), x[9], 0xeb86d391);
+
+#undef MD5_F
+#undef MD5_G
+#undef MD5_H
+#undef MD5_I
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+	}
+#endif
+};
+
+}
+
+/**
+ * Computes the MD5 of count independent messages, out[i] receives the digest
+ * of [data[i], data[i] + sizes[i]). Messages are hashed in parallel SIMD
+ * lanes, 16 at a time with AVX-512, 8 with AVX2 and 4 with SSE2 (or the
+ * generic vector unit on other targets). This is much faster than hashing
+ * them one by one when the messages are small.
+ */
+inline void md5_batch(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, md5::digest *out) {
+	detail::hash_messages<detail::md5_lanes>(data, sizes, count, out);
+}
+
+/**
+ * Convenience form of md5_batch for any container of messages, where each
+ * message has contiguous data() and size() members (std::string,
+ * std::vector<uint8_t>, etc.)
+ */
+template <class Container>
+std::vector<md5::digest> md5_batch(const Container &messages) {
+	std::vector<const uint8_t *> data;
+	std::vector<std::size_t> sizes;
+	for (const auto &message : messages) {
+		data.push_back(reinterpret_cast<const uint8_t *>(message.data()));
+		sizes.push_back(message.size());
+	}
+
+	std::vector<md5::digest> digests(data.size());
+	md5_batch(data.data(), sizes.data(), data.size(), digests.data());
+	return digests;
+}
+
+template <class T, std::size_t N>
+std::array<md5::digest, N> md5_batch(const std::array<T, N> &messages) {
+	const uint8_t *data[N];
+	std::size_t sizes[N];
+	for (std::size_t i = 0; i < N; ++i) {
+		data[i]  = reinterpret_cast<const uint8_t *>(messages[i].data());
+		sizes[i] = messages[i].size();
+	}
+
+	std::array<md5::digest, N> digests;
+	md5_batch(data, sizes, N, digests.data());
+	return digests;
+}
+
+}
+
+#endif
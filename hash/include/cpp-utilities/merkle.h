@@ -0,0 +1,272 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MERKLE_20261017_H_
+#define MERKLE_20261017_H_
+
+#include <algorithm>
+#include <cpp-utilities/thread_pool.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hash {
+namespace detail {
+
+// a few ranges per thread, so a thread which finishes early can take
+// another, without the queueing and locking of a task per item
+constexpr std::size_t parallel_for_ranges_per_thread = 4;
+
+// runs function(i) for every i in [0, count) on the pool and waits for them
+// all. The items are split into contiguous ranges, with one task per range
+template <class Function>
+void parallel_for(thread_pool &pool, std::size_t count, Function function) {
+	const std::size_t threads = std::max<std::size_t>(pool.size(), 1);
+	const std::size_t ranges  = std::min(count, threads * parallel_for_ranges_per_thread);
+	if (ranges == 0) {
+		return;
+	}
+
+	countdown_latch latch(ranges);
+
+	for (std::size_t r = 0; r < ranges; ++r) {
+		// spread the remainder over the first ranges
+		const std::size_t first = r * (count / ranges) + std::min(r, count % ranges);
+		const std::size_t last  = first + count / ranges + (r < count % ranges ? 1 : 0);
+
+		pool.add_worker([&, first, last]() {
+			for (std::size_t i = first; i < last; ++i) {
+				function(i);
+			}
+			latch.count_down();
+		});
+	}
+
+	latch.wait();
+}
+
+}
+
+/**
+ * A Merkle tree (tree hash) of a buffer, split into chunk_size leaves. Each
+ * leaf is hashed independently, which can be done in parallel on a
+ * thread_pool, and pairs of nodes are hashed together level by level up to
+ * a single root. A node without a sibling is carried up to the next level
+ * unchanged.
+ *
+ * To keep a leaf from ever being mistaken for an interior node, leaves are
+ * hashed as H(0x00 || chunk) and interior nodes as H(0x01 || left || right),
+ * like RFC 6962.
+ *
+ * Once built, a changed chunk only needs its own leaf and the log2(leaves)
+ * nodes above it rehashed (update_leaf), and proof() gives the sibling
+ * hashes needed to check a single chunk against the root (verify).
+ *
+ * Hasher can be any of the hashers in this library (md5, sha1, sha256...)
+ */
+template <class Hasher>
+class merkle_tree {
+public:
+	using digest = typename Hasher::digest;
+
+	struct proof_step {
+		digest sibling;
+		bool left; // true if sibling is the left hand node
+	};
+
+	using proof_type = std::vector<proof_step>;
+
+public:
+	/**
+	 * Builds the tree of [data, data + size), hashing the leaves on pool.
+	 *
+	 * NOTE: this blocks until all leaves are done, so it must not be called
+	 * from one of pool's own workers.
+	 */
+	merkle_tree(const void *data, std::size_t size, std::size_t chunk_size, thread_pool &pool)
+		: chunk_size_(std::max<std::size_t>(chunk_size, 1)) {
+
+		const auto p = static_cast<const uint8_t *>(data);
+
+		std::vector<digest> leaves(leaf_count(size));
+		detail::parallel_for(pool, leaves.size(), [&](std::size_t i) {
+			leaves[i] = hash_chunk(p, size, i);
+		});
+
+		build(std::move(leaves));
+	}
+
+	merkle_tree(const void *data, std::size_t size, std::size_t chunk_size)
+		: chunk_size_(std::max<std::size_t>(chunk_size, 1)) {
+
+		const auto p = static_cast<const uint8_t *>(data);
+
+		std::vector<digest> leaves(leaf_count(size));
+		for (std::size_t i = 0; i < leaves.size(); ++i) {
+			leaves[i] = hash_chunk(p, size, i);
+		}
+
+		build(std::move(leaves));
+	}
+
+	merkle_tree(const std::string &s, std::size_t chunk_size, thread_pool &pool)
+		: merkle_tree(s.data(), s.size(), chunk_size, pool) {
+	}
+
+	merkle_tree(const std::string &s, std::size_t chunk_size)
+		: merkle_tree(s.data(), s.size(), chunk_size) {
+	}
+
+	merkle_tree(const merkle_tree &other)            = default;
+	merkle_tree &operator=(const merkle_tree &other) = default;
+	merkle_tree(merkle_tree &&other)                 = default;
+	merkle_tree &operator=(merkle_tree &&other)      = default;
+
+public:
+	digest root() const {
+		return levels_.back().front();
+	}
+
+	digest leaf(std::size_t index) const {
+		return levels_.front()[index];
+	}
+
+	std::size_t leaves() const {
+		return levels_.front().size();
+	}
+
+	std::size_t chunk_size() const {
+		return chunk_size_;
+	}
+
+public:
+	/**
+	 * Replaces the contents of leaf index with [data, data + size) and
+	 * rehashes the path from it to the root
+	 */
+	void update_leaf(std::size_t index, const void *data, std::size_t size) {
+		update_leaf(index, hash_leaf(data, size));
+	}
+
+	void update_leaf(std::size_t index, const digest &leaf) {
+		levels_.front()[index] = leaf;
+
+		for (std::size_t level = 1; level < levels_.size(); ++level) {
+			index /= 2;
+			levels_[level][index] = parent(levels_[level - 1], index);
+		}
+	}
+
+	/**
+	 * The sibling hashes from leaf index up to the root, which together with
+	 * the leaf's data are enough to recompute the root
+	 */
+	proof_type proof(std::size_t index) const {
+		proof_type steps;
+		for (std::size_t level = 0; level + 1 < levels_.size(); ++level) {
+			const std::vector<digest> &nodes = levels_[level];
+			const std::size_t sibling        = index ^ 1;
+
+			// carried up unchanged, so there is nothing to combine with
+			if (sibling < nodes.size()) {
+				steps.push_back(proof_step{nodes[sibling], sibling < index});
+			}
+
+			index /= 2;
+		}
+		return steps;
+	}
+
+	static bool verify(const digest &root, const void *data, std::size_t size, const proof_type &proof) {
+		return verify(root, hash_leaf(data, size), proof);
+	}
+
+	static bool verify(const digest &root, const digest &leaf, const proof_type &proof) {
+		digest node = leaf;
+		for (const proof_step &step : proof) {
+			node = step.left ? hash_node(step.sibling, node) : hash_node(node, step.sibling);
+		}
+		return node == root;
+	}
+
+public:
+	static digest hash_leaf(const void *data, std::size_t size) {
+		Hasher h;
+		h.update(uint8_t(0x00));
+		h.update(data, size);
+		return h.finalize();
+	}
+
+	static digest hash_node(const digest &left, const digest &right) {
+		const auto l = left.bytes();
+		const auto r = right.bytes();
+
+		Hasher h;
+		h.update(uint8_t(0x01));
+		h.update(l.data(), l.size());
+		h.update(r.data(), r.size());
+		return h.finalize();
+	}
+
+private:
+	// an empty buffer still has a single (empty) leaf
+	std::size_t leaf_count(std::size_t size) const {
+		return std::max<std::size_t>((size + chunk_size_ - 1) / chunk_size_, 1);
+	}
+
+	digest hash_chunk(const uint8_t *p, std::size_t size, std::size_t index) const {
+		const std::size_t offset = std::min(index * chunk_size_, size);
+		return hash_leaf(p + offset, std::min(chunk_size_, size - offset));
+	}
+
+	static digest parent(const std::vector<digest> &children, std::size_t index) {
+		const std::size_t left = index * 2;
+		return (left + 1 < children.size()) ? hash_node(children[left], children[left + 1]) : children[left];
+	}
+
+	void build(std::vector<digest> leaves) {
+		levels_.clear();
+		levels_.push_back(std::move(leaves));
+
+		while (levels_.back().size() > 1) {
+			const std::vector<digest> &children = levels_.back();
+
+			std::vector<digest> nodes((children.size() + 1) / 2);
+			for (std::size_t i = 0; i < nodes.size(); ++i) {
+				nodes[i] = parent(children, i);
+			}
+
+			levels_.push_back(std::move(nodes));
+		}
+	}
+
+private:
+	std::size_t chunk_size_;
+	std::vector<std::vector<digest>> levels_;
+};
+
+}
+
+#endif
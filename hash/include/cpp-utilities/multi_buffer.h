@@ -0,0 +1,299 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MULTI_BUFFER_20261017_H_
+#define MULTI_BUFFER_20261017_H_
+
+#include <algorithm>
+#include <cpp-utilities/hash_detail.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+/*
+ * Shared machinery for hashing many independent messages at once with a
+ * Merkle-Damgard style hash (64 byte blocks, 64-bit bit length in the final
+ * block). Each SIMD lane owns one message, so the long dependency chain of a
+ * single hash is spread over 4, 8 or 16 messages.
+ *
+ * A Traits type supplies the algorithm specific parts:
+ *
+ *   using digest                  the hasher's digest type
+ *   static constexpr Words        number of 32-bit chaining words
+ *   static constexpr BigEndian    how the bit length is stored
+ *   static const uint32_t *iv()   the initial chaining words
+ *   static void compress(V *state, const uint8_t *const *blocks)
+ *                                 one block for every lane, V is a vector of
+ *                                 32-bit words, one element per lane
+ *   static void load(const uint32_t *words, digest *d)
+ *   static void process(digest *d, const uint8_t *blocks, size_t count)
+ *                                 the scalar transform, used to finish the
+ *                                 blocks left over for a lane
+ *   static bool prefer_scalar()   true when the scalar transform beats the
+ *                                 lanes anyway (e.g. it has hardware support)
+ */
+namespace hash {
+namespace detail {
+
+constexpr std::size_t multi_buffer_max_lanes = 16;
+constexpr std::size_t multi_buffer_buckets   = 16;
+
+// a message split into whole blocks taken from the caller's buffer, and the
+// final one or two blocks which hold the padding and length
+template <bool BigEndian>
+class padded_message {
+public:
+	static constexpr std::size_t BlockSize = 64;
+
+public:
+	void assign(const uint8_t *data, std::size_t size) {
+		data_  = data;
+		whole_ = size / BlockSize;
+
+		const std::size_t rest = size % BlockSize;
+		const std::size_t tail = (rest < BlockSize - 8) ? 1 : 2;
+
+		if (rest != 0) {
+			std::memcpy(tail_, data + whole_ * BlockSize, rest);
+		}
+		tail_[rest] = 0x80;
+		std::memset(&tail_[rest + 1], 0, tail * BlockSize - 8 - (rest + 1));
+
+		const uint64_t bits   = static_cast<uint64_t>(size) * 8;
+		uint8_t *const length = &tail_[tail * BlockSize - 8];
+		for (int i = 0; i < 8; ++i) {
+			length[i] = static_cast<uint8_t>(bits >> (BigEndian ? (56 - 8 * i) : (8 * i)));
+		}
+
+		blocks_ = whole_ + tail;
+	}
+
+	std::size_t blocks() const {
+		return blocks_;
+	}
+
+	const uint8_t *block(std::size_t index) const {
+		return (index < whole_) ? data_ + index * BlockSize : tail_ + (index - whole_) * BlockSize;
+	}
+
+	// the tail blocks are contiguous, as are the whole ones
+	std::size_t contiguous(std::size_t index) const {
+		return (index < whole_) ? whole_ - index : blocks_ - index;
+	}
+
+	static std::size_t blocks_for(std::size_t size) {
+		return size / BlockSize + ((size % BlockSize < BlockSize - 8) ? 1 : 2);
+	}
+
+private:
+	const uint8_t *data_ = nullptr;
+	std::size_t whole_   = 0;
+	std::size_t blocks_  = 0;
+	uint8_t tail_[BlockSize * 2];
+};
+
+template <class Traits>
+using lane_function = void (*)(const padded_message<Traits::BigEndian> *, std::size_t, uint32_t (*)[Traits::Words]);
+
+#ifdef HASH_VECTOR_EXTENSIONS
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+typedef uint32_t u32x16 __attribute__((vector_size(64)));
+
+// NOTE: vectors are passed by reference throughout, passing wide vectors by
+// value from code which isn't compiled for AVX changes the ABI
+template <class V>
+HASH_ALWAYS_INLINE void gather_word(V &v, const uint8_t *const *blocks, std::size_t index, bool big_endian) {
+	for (std::size_t lane = 0; lane < sizeof(V) / sizeof(uint32_t); ++lane) {
+		uint32_t word;
+		std::memcpy(&word, blocks[lane] + index * 4, sizeof(word));
+		v[lane] = big_endian ? __builtin_bswap32(word) : word;
+	}
+}
+
+// runs the first count blocks of every lane, and stores each lane's chaining words
+template <class Traits, class V>
+HASH_ALWAYS_INLINE void compress_lanes(const padded_message<Traits::BigEndian> *messages, std::size_t count, uint32_t (*words)[Traits::Words]) {
+	constexpr std::size_t Lanes = sizeof(V) / sizeof(uint32_t);
+
+	V state[Traits::Words];
+	for (std::size_t w = 0; w < Traits::Words; ++w) {
+		for (std::size_t lane = 0; lane < Lanes; ++lane) {
+			state[w][lane] = Traits::iv()[w];
+		}
+	}
+
+	const uint8_t *blocks[Lanes];
+	for (std::size_t i = 0; i < count; ++i) {
+		for (std::size_t lane = 0; lane < Lanes; ++lane) {
+			blocks[lane] = messages[lane].block(i);
+		}
+		Traits::compress(state, blocks);
+	}
+
+	for (std::size_t lane = 0; lane < Lanes; ++lane) {
+		for (std::size_t w = 0; w < Traits::Words; ++w) {
+			words[lane][w] = state[w][lane];
+		}
+	}
+}
+
+template <class Traits>
+void compress_lanes_x4(const padded_message<Traits::BigEndian> *messages, std::size_t count, uint32_t (*words)[Traits::Words]) {
+	compress_lanes<Traits, u32x4>(messages, count, words);
+}
+
+#ifdef HASH_X86_64_DISPATCH
+template <class Traits>
+__attribute__((target("avx2"))) void compress_lanes_x8(const padded_message<Traits::BigEndian> *messages, std::size_t count, uint32_t (*words)[Traits::Words]) {
+	compress_lanes<Traits, u32x8>(messages, count, words);
+}
+
+template <class Traits>
+__attribute__((target("avx512f"))) void compress_lanes_x16(const padded_message<Traits::BigEndian> *messages, std::size_t count, uint32_t (*words)[Traits::Words]) {
+	compress_lanes<Traits, u32x16>(messages, count, words);
+}
+#endif
+#endif
+
+template <class Traits>
+struct lane_kernel {
+	lane_function<Traits> function = nullptr;
+	std::size_t lanes              = 0;
+};
+
+// picks the widest lane kernel the CPU supports, 0 lanes if there are none
+template <class Traits>
+lane_kernel<Traits> select_lane_kernel() {
+	lane_kernel<Traits> kernel;
+	if (Traits::prefer_scalar()) {
+		return kernel;
+	}
+
+#ifdef HASH_VECTOR_EXTENSIONS
+#ifdef HASH_X86_64_DISPATCH
+	if (cpu().avx512f) {
+		kernel.function = compress_lanes_x16<Traits>;
+		kernel.lanes    = 16;
+		return kernel;
+	}
+
+	if (cpu().avx2) {
+		kernel.function = compress_lanes_x8<Traits>;
+		kernel.lanes    = 8;
+		return kernel;
+	}
+#endif
+	kernel.function = compress_lanes_x4<Traits>;
+	kernel.lanes    = 4;
+#endif
+	return kernel;
+}
+
+template <class Traits>
+void finish_lane(const uint32_t *words, const padded_message<Traits::BigEndian> &message, std::size_t index, typename Traits::digest *out) {
+	typename Traits::digest d;
+	Traits::load(words, &d);
+
+	// the remaining blocks are at most two contiguous runs
+	while (index < message.blocks()) {
+		const std::size_t n = message.contiguous(index);
+		Traits::process(&d, message.block(index), n);
+		index += n;
+	}
+
+	*out = d;
+}
+
+/*
+ * hashes count messages, writing the digest of data[i] to out[i]. Groups of
+ * messages with similar lengths are run through the SIMD kernel together for
+ * as many blocks as they all have, anything left over (including the final
+ * messages which don't fill a group) is finished with the scalar transform.
+ */
+template <class Traits>
+void hash_messages(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, typename Traits::digest *out) {
+	using message_type = padded_message<Traits::BigEndian>;
+
+	static const lane_kernel<Traits> kernel = select_lane_kernel<Traits>();
+	const std::size_t lanes                 = kernel.lanes;
+
+	message_type messages[multi_buffer_max_lanes];
+	uint32_t words[multi_buffer_max_lanes][Traits::Words];
+
+	if (lanes == 0) {
+		for (std::size_t i = 0; i < count; ++i) {
+			messages[0].assign(data[i], sizes[i]);
+			finish_lane<Traits>(Traits::iv(), messages[0], 0, &out[i]);
+		}
+		return;
+	}
+
+	// grouping by length keeps the lanes of a group busy for the same number
+	// of blocks. A counting sort on the (capped) block count is plenty for
+	// that and, unlike a comparison sort, doesn't dwarf the hashing itself
+	auto bucket = [sizes](std::size_t i) {
+		return std::min(message_type::blocks_for(sizes[i]), multi_buffer_buckets) - 1;
+	};
+
+	std::size_t starts[multi_buffer_buckets + 1] = {};
+	for (std::size_t i = 0; i < count; ++i) {
+		++starts[bucket(i) + 1];
+	}
+	std::partial_sum(starts, starts + multi_buffer_buckets + 1, starts);
+
+	std::vector<std::size_t> order(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		order[starts[bucket(i)]++] = i;
+	}
+
+	std::size_t next = 0;
+	for (; count - next >= lanes; next += lanes) {
+		std::size_t common = static_cast<std::size_t>(-1);
+		for (std::size_t lane = 0; lane < lanes; ++lane) {
+			const std::size_t i = order[next + lane];
+			messages[lane].assign(data[i], sizes[i]);
+			common = std::min(common, messages[lane].blocks());
+		}
+
+		kernel.function(messages, common, words);
+
+		for (std::size_t lane = 0; lane < lanes; ++lane) {
+			finish_lane<Traits>(words[lane], messages[lane], common, &out[order[next + lane]]);
+		}
+	}
+
+	for (; next < count; ++next) {
+		const std::size_t i = order[next];
+		messages[0].assign(data[i], sizes[i]);
+		finish_lane<Traits>(Traits::iv(), messages[0], 0, &out[i]);
+	}
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MULTI_HASHER_20261017_H_
+#define MULTI_HASHER_20261017_H_
+
+#include <algorithm>
+#include <cpp-utilities/hash_detail.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace hash {
+
+/**
+ * Computes several digests of the same data in a single pass, for example
+ * multi_hasher<crc32, md5, sha1>. Input is handed to every hasher's bulk
+ * update in ChunkSize pieces, small enough that the later hashers read each
+ * piece back out of L1 rather than from memory.
+ *
+ * finalize() returns a std::tuple of the digests, in the order the hashers
+ * were given, and like the hashers themselves doesn't modify the state.
+ */
+template <class... Hashers>
+class multi_hasher {
+public:
+	using digest = std::tuple<typename Hashers::digest...>;
+
+	static constexpr std::size_t ChunkSize = 16 * 1024;
+
+public:
+	template <class In>
+	multi_hasher(In first, In last) {
+		update(first, last);
+	}
+
+	multi_hasher(const std::string &s) {
+		update(s);
+	}
+
+	multi_hasher(const void *data, std::size_t size) {
+		update(data, size);
+	}
+
+	multi_hasher()                                   = default;
+	multi_hasher(const multi_hasher &other)          = default;
+	multi_hasher &operator=(const multi_hasher &rhs) = default;
+
+public:
+	template <class In>
+	multi_hasher &update(In first, In last) {
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
+		return *this;
+	}
+
+	multi_hasher &update(uint8_t byte) {
+		update_all(&byte, 1, std::index_sequence_for<Hashers...>());
+		return *this;
+	}
+
+	multi_hasher &update(const std::string &s) {
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	multi_hasher &update(const void *data, std::size_t size) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		while (size != 0) {
+			const std::size_t n = (size < ChunkSize) ? size : ChunkSize;
+			update_all(p, n, std::index_sequence_for<Hashers...>());
+			p += n;
+			size -= n;
+		}
+		return *this;
+	}
+
+public:
+	void swap(multi_hasher &other) {
+		using std::swap;
+		swap(hashers_, other.hashers_);
+	}
+
+	void clear() {
+		hashers_ = std::tuple<Hashers...>();
+	}
+
+	digest finalize() const {
+		return finalize_all(std::index_sequence_for<Hashers...>());
+	}
+
+	// the individual hashers, by position
+	template <std::size_t I>
+	const typename std::tuple_element<I, std::tuple<Hashers...>>::type &get() const {
+		return std::get<I>(hashers_);
+	}
+
+private:
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	// gathered into a buffer first, so the hashers still see large pieces
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		uint8_t buffer[4096];
+		std::size_t n = 0;
+
+		while (first != last) {
+			buffer[n++] = static_cast<uint8_t>(*first++);
+			if (n == sizeof(buffer)) {
+				update(buffer, n);
+				n = 0;
+			}
+		}
+
+		update(buffer, n);
+	}
+
+	template <std::size_t... I>
+	void update_all(const uint8_t *p, std::size_t n, std::index_sequence<I...>) {
+		using expand = int[];
+		(void)expand{0, (std::get<I>(hashers_).update(static_cast<const void *>(p), n), 0)...};
+	}
+
+	template <std::size_t... I>
+	digest finalize_all(std::index_sequence<I...>) const {
+		return digest(std::get<I>(hashers_).finalize()...);
+	}
+
+private:
+	std::tuple<Hashers...> hashers_;
+};
+
+}
+
+#endif
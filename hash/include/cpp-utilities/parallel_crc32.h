@@ -0,0 +1,99 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARALLEL_CRC32_20261017_H_
+#define PARALLEL_CRC32_20261017_H_
+
+#include <algorithm>
+#include <cpp-utilities/crc32.h>
+#include <cpp-utilities/thread_pool.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hash {
+
+/**
+ * Computes the CRC of [data, data + size) by splitting it into chunk_size
+ * pieces, checksumming them on the thread pool and folding the partial
+ * results together with Crc::combine. The result is identical to hashing
+ * the buffer serially.
+ *
+ * NOTE: this blocks until all chunks are done, so it must not be called from
+ * one of pool's own workers.
+ *
+ * @param data the buffer to checksum
+ * @param size the size of the buffer in bytes
+ * @param pool the thread pool to run the chunks on
+ * @param chunk_size the number of bytes each work item will process
+ * @return the digest of the whole buffer
+ */
+template <class Crc>
+typename Crc::digest parallel_crc(const void *data, std::size_t size, thread_pool &pool, std::size_t chunk_size) {
+	using digest = typename Crc::digest;
+
+	const auto p = static_cast<const uint8_t *>(data);
+
+	if (chunk_size == 0 || size <= chunk_size) {
+		return Crc(p, p + size).finalize();
+	}
+
+	const std::size_t chunks = (size + chunk_size - 1) / chunk_size;
+
+	std::vector<digest> results(chunks);
+	countdown_latch latch(chunks);
+
+	for (std::size_t i = 0; i < chunks; ++i) {
+		pool.add_worker([&, i]() {
+			const std::size_t offset = i * chunk_size;
+			const std::size_t length = std::min(chunk_size, size - offset);
+
+			results[i] = Crc(p + offset, p + offset + length).finalize();
+			latch.count_down();
+		});
+	}
+
+	latch.wait();
+
+	digest d = results[0];
+	for (std::size_t i = 1; i < chunks; ++i) {
+		const std::size_t offset = i * chunk_size;
+		d                        = Crc::combine(d, results[i], std::min(chunk_size, size - offset));
+	}
+
+	return d;
+}
+
+inline crc32::digest parallel_crc32(const void *data, std::size_t size, thread_pool &pool, std::size_t chunk_size = 1024 * 1024) {
+	return parallel_crc<crc32>(data, size, pool, chunk_size);
+}
+
+inline crc32::digest parallel_crc32(const std::string &s, thread_pool &pool, std::size_t chunk_size = 1024 * 1024) {
+	return parallel_crc32(s.data(), s.size(), pool, chunk_size);
+}
+
+}
+
+#endif
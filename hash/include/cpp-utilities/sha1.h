@@ -29,6 +29,9 @@
 #include <array>
 #include <climits>
 #include <cpp-utilities/bitwise.h>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hash_state.h>
+#include <cpp-utilities/hex.h>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -36,41 +39,131 @@
 
 namespace hash {
 
-class sha1 {
+namespace detail {
+struct sha1_lanes;
+
+#ifdef HASH_X86_64_DISPATCH
+// four rounds of the SHA-NI transform. m holds the message schedule as a ring
+// of four registers, and e alternates between holding the E for this group
+// and the next, exactly as in Intel's reference implementation
+template <int Group>
+__attribute__((target("sha,sse4.1"), always_inline)) inline void sha1_ni_rounds(__m128i &abcd, __m128i *e, __m128i *m) {
+	__m128i &e_in  = e[Group % 2];
+	__m128i &e_out = e[(Group + 1) % 2];
+
+	if (Group == 0) {
+		e_in = _mm_add_epi32(e_in, m[0]);
+	} else {
+		e_in = _mm_sha1nexte_epu32(e_in, m[Group % 4]);
+	}
+
+	e_out = abcd;
+
+	if (Group >= 3 && Group <= 18) {
+		m[(Group + 1) % 4] = _mm_sha1msg2_epu32(m[(Group + 1) % 4], m[Group % 4]);
+	}
+
+	abcd = _mm_sha1rnds4_epu32(abcd, e_in, Group / 5);
+
+	if (Group >= 1 && Group <= 16) {
+		m[(Group + 3) % 4] = _mm_sha1msg1_epu32(m[(Group + 3) % 4], m[Group % 4]);
+	}
+
+	if (Group >= 2 && Group <= 17) {
+		m[(Group + 2) % 4] = _mm_xor_si128(m[(Group + 2) % 4], m[Group % 4]);
+	}
+}
+
+__attribute__((target("sha,sse4.1"))) inline void sha1_ni_transform(uint32_t *h, const uint8_t *block, std::size_t count) {
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)), 0x1b);
+	__m128i e[2];
+	e[0] = _mm_set_epi32(static_cast<int>(h[4]), 0, 0, 0);
+
+	while (count--) {
+		const __m128i abcd_save = abcd;
+		const __m128i e_save    = e[0];
+
+		__m128i m[4];
+		for (int i = 0; i < 4; ++i) {
+			m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16)), mask);
+		}
+
+		sha1_ni_rounds<0>(abcd, e, m);
+		sha1_ni_rounds<1>(abcd, e, m);
+		sha1_ni_rounds<2>(abcd, e, m);
+		sha1_ni_rounds<3>(abcd, e, m);
+		sha1_ni_rounds<4>(abcd, e, m);
+		sha1_ni_rounds<5>(abcd, e, m);
+		sha1_ni_rounds<6>(abcd, e, m);
+		sha1_ni_rounds<7>(abcd, e, m);
+		sha1_ni_rounds<8>(abcd, e, m);
+		sha1_ni_rounds<9>(abcd, e, m);
+		sha1_ni_rounds<10>(abcd, e, m);
+		sha1_ni_rounds<11>(abcd, e, m);
+		sha1_ni_rounds<12>(abcd, e, m);
+		sha1_ni_rounds<13>(abcd, e, m);
+		sha1_ni_rounds<14>(abcd, e, m);
+		sha1_ni_rounds<15>(abcd, e, m);
+		sha1_ni_rounds<16>(abcd, e, m);
+		sha1_ni_rounds<17>(abcd, e, m);
+		sha1_ni_rounds<18>(abcd, e, m);
+		sha1_ni_rounds<19>(abcd, e, m);
+
+		e[0] = _mm_sha1nexte_epu32(e[0], e_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+
+		block += 64;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(h), _mm_shuffle_epi32(abcd, 0x1b));
+	h[4] = static_cast<uint32_t>(_mm_extract_epi32(e[0], 3));
+}
+#endif
+}
+
+class sha1 : public detail::string_updates<sha1> {
+	friend struct detail::sha1_lanes;
+
 public:
 	struct state {
 		static constexpr int BlockSize = 64;
 
-		uint8_t block_[BlockSize]; // 512-bit message blocks
+		uint8_t block_[BlockSize] = {}; // 512-bit message blocks
 		uint64_t length_   = 0;    // message length in bits
 		std::size_t index_ = 0;    // index into message block array
 	};
 
 	class digest {
 		friend class sha1;
+		friend struct detail::sha1_lanes;
 
 	public:
-		std::string to_string() const {
-			static const char hexchars[] = "0123456789abcdef";
-			std::string str;
-			str.reserve(40);
-
-			auto p = std::back_inserter(str);
+		static constexpr std::size_t HexSize = 40;
 
-			for (int i = 0; i < 5; ++i) {
-				*p++ = hexchars[(h_[i] & 0xf0000000) >> 0x1c];
-				*p++ = hexchars[(h_[i] & 0x0f000000) >> 0x18];
-				*p++ = hexchars[(h_[i] & 0x00f00000) >> 0x14];
-				*p++ = hexchars[(h_[i] & 0x000f0000) >> 0x10];
-				*p++ = hexchars[(h_[i] & 0x0000f000) >> 0x0c];
-				*p++ = hexchars[(h_[i] & 0x00000f00) >> 0x08];
-				*p++ = hexchars[(h_[i] & 0x000000f0) >> 0x04];
-				*p++ = hexchars[(h_[i] & 0x0000000f) >> 0x00];
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
 			}
 
+			const auto b = bytes();
+			detail::hex_encode(b.data(), b.size(), first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
 			return str;
 		}
 
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
 		std::array<uint8_t, 20> bytes() const {
 			std::array<uint8_t, 20> b;
 
@@ -83,11 +176,16 @@ public:
 
 			return b;
 		}
-		bool operator==(const digest &rhs) const {
-			return std::memcmp(h_, rhs.h_, sizeof(h_)) == 0;
+		HASH_CONSTEXPR14 bool operator==(const digest &rhs) const {
+			for (int i = 0; i < 5; ++i) {
+				if (h_[i] != rhs.h_[i]) {
+					return false;
+				}
+			}
+			return true;
 		}
 
-		bool operator!=(const digest &rhs) const {
+		HASH_CONSTEXPR14 bool operator!=(const digest &rhs) const {
 			return !(*this == rhs);
 		}
 
@@ -111,6 +209,18 @@ public:
 		update(s);
 	}
 
+	template <class Char, std::size_t N, class = detail::if_string_literal<Char>>
+	HASH_CONSTEXPR14 sha1(Char (&s)[N]) {
+		update(s);
+	}
+
+#if __cplusplus >= 201703L
+	template <class View, class = detail::if_string_view<View>>
+	HASH_CONSTEXPR14 sha1(View s) {
+		update(s);
+	}
+#endif
+
 	sha1()                           = default;
 	sha1(const sha1 &other)          = default;
 	sha1 &operator=(const sha1 &rhs) = default;
@@ -118,13 +228,11 @@ public:
 public:
 	template <class In>
 	sha1 &update(In first, In last) {
-		while (first != last) {
-			update(*first++);
-		}
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
 		return *this;
 	}
 
-	sha1 &update(uint8_t byte) {
+	HASH_CONSTEXPR14 sha1 &update(uint8_t byte) {
 		state_.block_[state_.index_++] = byte;
 
 		state_.length_ += 8;
@@ -137,7 +245,41 @@ public:
 	}
 
 	sha1 &update(const std::string &s) {
-		update(s.begin(), s.end());
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	using detail::string_updates<sha1>::update;
+
+	sha1 &update(const void *data, std::size_t size) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		state_.length_ += static_cast<uint64_t>(size) * 8;
+
+		// top up any partially filled block first
+		if (state_.index_ != 0) {
+			const std::size_t n = std::min<std::size_t>(size, state::BlockSize - state_.index_);
+			std::memcpy(&state_.block_[state_.index_], p, n);
+			state_.index_ += n;
+			p += n;
+			size -= n;
+
+			if (state_.index_ == state::BlockSize) {
+				process_block(&state_, &digest_);
+			}
+		}
+
+		// whole blocks can be transformed straight out of the caller's buffer
+		const std::size_t blocks = size / state::BlockSize;
+		if (blocks != 0) {
+			process_blocks(p, blocks, &digest_);
+			p += blocks * state::BlockSize;
+			size -= blocks * state::BlockSize;
+		}
+
+		// and only the tail needs to be buffered
+		std::memcpy(&state_.block_[state_.index_], p, size);
+		state_.index_ += size;
 		return *this;
 	}
 
@@ -154,7 +296,32 @@ public:
 		state_  = state();
 	}
 
-	digest finalize() const {
+	static constexpr std::size_t StateSize = detail::hash_state_size(5);
+
+	/**
+	 * Checkpoints the hash of everything seen so far. Passing the result to
+	 * import_state (in this process or another) resumes hashing where it left
+	 * off, without having to feed the prefix through again. The format is
+	 * versioned and byte order independent, see hash_state.h
+	 */
+	std::array<uint8_t, StateSize> export_state() const {
+		return detail::export_hash_state<5>("SHA1", state_.length_, state_.index_, digest_.h_, state_.block_);
+	}
+
+	// returns false, leaving the hasher unchanged, if data isn't a valid SHA-1 state
+	bool import_state(const void *data, std::size_t size) {
+		state s;
+		digest d;
+		if (!detail::import_hash_state<5>("SHA1", data, size, &s.length_, &s.index_, d.h_, s.block_)) {
+			return false;
+		}
+
+		state_  = s;
+		digest_ = d;
+		return true;
+	}
+
+	HASH_CONSTEXPR14 digest finalize() const {
 		// make copies so this isn't a mutating operation
 		state s  = state_;
 		digest d = digest_;
@@ -190,21 +357,73 @@ public:
 	}
 
 private:
-	static void process_block(state *state, digest *digest) {
-		static constexpr uint32_t K[] = {
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(*first++);
+		}
+	}
+
+	static HASH_CONSTEXPR14 void process_block(state *state, digest *digest) {
+		if (detail::in_constant_evaluation()) {
+			transform(state->block_, digest);
+		} else {
+			process_blocks(state->block_, 1, digest);
+		}
+		state->index_ = 0;
+	}
+
+	using process_function = void (*)(const uint8_t *, std::size_t, digest *);
+
+	static void process_blocks(const uint8_t *block, std::size_t count, digest *digest) {
+		static const process_function function = select_process_blocks();
+		function(block, count, digest);
+	}
+
+	static process_function select_process_blocks() {
+#ifdef HASH_X86_64_DISPATCH
+		if (detail::cpu().sha && detail::cpu().sse41) {
+			return process_blocks_sha_ni;
+		}
+#endif
+		return process_blocks_generic;
+	}
+
+#ifdef HASH_X86_64_DISPATCH
+	static void process_blocks_sha_ni(const uint8_t *block, std::size_t count, digest *digest) {
+		detail::sha1_ni_transform(digest->h_, block, count);
+	}
+#endif
+
+	static void process_blocks_generic(const uint8_t *block, std::size_t count, digest *digest) {
+		while (count--) {
+			transform(block, digest);
+			block += state::BlockSize;
+		}
+	}
+
+	static HASH_CONSTEXPR14 void transform(const uint8_t *block, digest *digest) {
+		constexpr uint32_t K[] = {
 			0x5a827999,
 			0x6ed9eba1,
 			0x8f1bbcdc,
 			0xca62c1d6};
 
-		uint32_t W[80]; // Word sequence
+		uint32_t W[80] = {}; // Word sequence
 
 		//  Initialize the first 16 words in the array W
 		for (int t = 0; t < 16; ++t) {
-			W[t] = static_cast<uint32_t>(state->block_[t * 4 + 0]) << 24;
-			W[t] |= static_cast<uint32_t>(state->block_[t * 4 + 1]) << 16;
-			W[t] |= static_cast<uint32_t>(state->block_[t * 4 + 2]) << 8;
-			W[t] |= static_cast<uint32_t>(state->block_[t * 4 + 3]);
+			W[t] = static_cast<uint32_t>(block[t * 4 + 0]) << 24;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 1]) << 16;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 2]) << 8;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 3]);
 		}
 
 #if 0
@@ -274,8 +493,6 @@ private:
 		digest->h_[2] += C;
 		digest->h_[3] += D;
 		digest->h_[4] += E;
-
-		state->index_ = 0;
 	}
 
 private:
@@ -0,0 +1,163 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SHA1_BATCH_20261017_H_
+#define SHA1_BATCH_20261017_H_
+
+#include <array>
+#include <cpp-utilities/multi_buffer.h>
+#include <cpp-utilities/sha1.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hash {
+
+namespace detail {
+
+struct sha1_lanes {
+	using digest = sha1::digest;
+
+	static constexpr std::size_t Words = 5;
+	static constexpr bool BigEndian    = true;
+
+	static const uint32_t *iv() {
+		static const digest d;
+		return d.h_;
+	}
+
+	static void load(const uint32_t *words, digest *d) {
+		std::copy(words, words + Words, d->h_);
+	}
+
+	static void process(digest *d, const uint8_t *blocks, std::size_t count) {
+		sha1::process_blocks(blocks, count, d);
+	}
+
+	// a single SHA-NI stream outruns even 16 lanes of AVX-512
+	static bool prefer_scalar() {
+		return cpu().sha && cpu().sse41;
+	}
+
+#ifdef HASH_VECTOR_EXTENSIONS
+	template <class V>
+	static HASH_ALWAYS_INLINE void compress(V *state, const uint8_t *const *blocks) {
+		static constexpr uint32_t K[] = {
+			0x5a827999,
+			0x6ed9eba1,
+			0x8f1bbcdc,
+			0xca62c1d6};
+
+#define SHA1_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+		V W[80];
+		for (std::size_t t = 0; t < 16; ++t) {
+			gather_word(W[t], blocks, t, true);
+		}
+
+		for (std::size_t t = 16; t < 80; ++t) {
+			const V w = W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16];
+			W[t]      = SHA1_ROTL(w, 1);
+		}
+
+		V A = state[0];
+		V B = state[1];
+		V C = state[2];
+		V D = state[3];
+		V E = state[4];
+
+		for (std::size_t t = 0; t < 80; ++t) {
+			V f;
+			if (t < 20) {
+				f = D ^ (B & (C ^ D));
+			} else if (t < 40) {
+				f = B ^ C ^ D;
+			} else if (t < 60) {
+				f = (B & C) | (D & (B | C));
+			} else {
+				f = B ^ C ^ D;
+			}
+
+			const V temp = SHA1_ROTL(A, 5) + f + E + W[t] + K[t / 20];
+
+			E = D;
+			D = C;
+			C = SHA1_ROTL(B, 30);
+			B = A;
+			A = temp;
+		}
+
+#undef SHA1_ROTL
+
+		state[0] += A;
+		state[1] += B;
+		state[2] += C;
+		state[3] += D;
+		state[4] += E;
+	}
+#endif
+};
+
+}
+
+/**
+ * Computes the SHA-1 of count independent messages, out[i] receives the
+ * digest of [data[i], data[i] + sizes[i]). See md5_batch for how the work is
+ * spread over SIMD lanes.
+ */
+inline void sha1_batch(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, sha1::digest *out) {
+	detail::hash_messages<detail::sha1_lanes>(data, sizes, count, out);
+}
+
+template <class Container>
+std::vector<sha1::digest> sha1_batch(const Container &messages) {
+	std::vector<const uint8_t *> data;
+	std::vector<std::size_t> sizes;
+	for (const auto &message : messages) {
+		data.push_back(reinterpret_cast<const uint8_t *>(message.data()));
+		sizes.push_back(message.size());
+	}
+
+	std::vector<sha1::digest> digests(data.size());
+	sha1_batch(data.data(), sizes.data(), data.size(), digests.data());
+	return digests;
+}
+
+template <class T, std::size_t N>
+std::array<sha1::digest, N> sha1_batch(const std::array<T, N> &messages) {
+	const uint8_t *data[N];
+	std::size_t sizes[N];
+	for (std::size_t i = 0; i < N; ++i) {
+		data[i]  = reinterpret_cast<const uint8_t *>(messages[i].data());
+		sizes[i] = messages[i].size();
+	}
+
+	std::array<sha1::digest, N> digests;
+	sha1_batch(data, sizes, N, digests.data());
+	return digests;
+}
+
+}
+
+#endif
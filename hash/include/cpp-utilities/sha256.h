@@ -0,0 +1,461 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SHA256_20261017_H_
+#define SHA256_20261017_H_
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cpp-utilities/bitwise.h>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hash_state.h>
+#include <cpp-utilities/hex.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace hash {
+
+namespace detail {
+
+inline const uint32_t *sha256_constants() {
+	static constexpr uint32_t K[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+	};
+
+	return K;
+}
+
+#ifdef HASH_X86_64_DISPATCH
+// four rounds of the SHA-NI transform. m holds the message schedule as a ring
+// of four registers, following the layout of Intel's reference implementation
+template <int Group>
+__attribute__((target("sha,sse4.1"), always_inline)) inline void sha256_ni_rounds(__m128i &abef, __m128i &cdgh, __m128i *m) {
+	const __m128i &current = m[Group % 4];
+
+	__m128i msg = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i *>(sha256_constants() + Group * 4)));
+	cdgh        = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+
+	if (Group >= 3 && Group <= 14) {
+		__m128i &next = m[(Group + 1) % 4];
+		next          = _mm_add_epi32(next, _mm_alignr_epi8(current, m[(Group + 3) % 4], 4));
+		next          = _mm_sha256msg2_epu32(next, current);
+	}
+
+	msg  = _mm_shuffle_epi32(msg, 0x0e);
+	abef = _mm_sha256rnds2_epu32(abef, cdgh, msg);
+
+	if (Group >= 1 && Group <= 12) {
+		m[(Group + 3) % 4] = _mm_sha256msg1_epu32(m[(Group + 3) % 4], current);
+	}
+}
+
+__attribute__((target("sha,sse4.1"))) inline void sha256_ni_transform(uint32_t *h, const uint8_t *block, std::size_t count) {
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	// the instructions want the state as ABEF and CDGH
+	const __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)), 0xb1);
+	const __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h + 4)), 0x1b);
+
+	__m128i abef = _mm_alignr_epi8(dcba, efgh, 8);
+	__m128i cdgh = _mm_blend_epi16(efgh, dcba, 0xf0);
+
+	while (count--) {
+		const __m128i abef_save = abef;
+		const __m128i cdgh_save = cdgh;
+
+		__m128i m[4];
+		for (int i = 0; i < 4; ++i) {
+			m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16)), mask);
+		}
+
+		sha256_ni_rounds<0>(abef, cdgh, m);
+		sha256_ni_rounds<1>(abef, cdgh, m);
+		sha256_ni_rounds<2>(abef, cdgh, m);
+		sha256_ni_rounds<3>(abef, cdgh, m);
+		sha256_ni_rounds<4>(abef, cdgh, m);
+		sha256_ni_rounds<5>(abef, cdgh, m);
+		sha256_ni_rounds<6>(abef, cdgh, m);
+		sha256_ni_rounds<7>(abef, cdgh, m);
+		sha256_ni_rounds<8>(abef, cdgh, m);
+		sha256_ni_rounds<9>(abef, cdgh, m);
+		sha256_ni_rounds<10>(abef, cdgh, m);
+		sha256_ni_rounds<11>(abef, cdgh, m);
+		sha256_ni_rounds<12>(abef, cdgh, m);
+		sha256_ni_rounds<13>(abef, cdgh, m);
+		sha256_ni_rounds<14>(abef, cdgh, m);
+		sha256_ni_rounds<15>(abef, cdgh, m);
+
+		abef = _mm_add_epi32(abef, abef_save);
+		cdgh = _mm_add_epi32(cdgh, cdgh_save);
+
+		block += 64;
+	}
+
+	const __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+	const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(h), _mm_blend_epi16(feba, dchg, 0xf0));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(h + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+}
+
+class sha256 {
+public:
+	struct state {
+		static constexpr int BlockSize = 64;
+
+		uint8_t block_[BlockSize] = {}; // 512-bit message blocks
+		uint64_t length_   = 0;    // message length in bits
+		std::size_t index_ = 0;    // index into message block array
+	};
+
+	class digest {
+		friend class sha256;
+
+	public:
+		static constexpr std::size_t HexSize = 64;
+
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
+			}
+
+			const auto b = bytes();
+			detail::hex_encode(b.data(), b.size(), first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
+			return str;
+		}
+
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
+		std::array<uint8_t, 32> bytes() const {
+			std::array<uint8_t, 32> b;
+
+			for (int i = 0; i < 8; ++i) {
+				b[3 + (i * 4)] = (h_[i] & 0x000000ff);
+				b[2 + (i * 4)] = (h_[i] & 0x0000ff00) >> 8;
+				b[1 + (i * 4)] = (h_[i] & 0x00ff0000) >> 16;
+				b[0 + (i * 4)] = (h_[i] & 0xff000000) >> 24;
+			}
+
+			return b;
+		}
+
+		bool operator==(const digest &rhs) const {
+			return std::memcmp(h_, rhs.h_, sizeof(h_)) == 0;
+		}
+
+		bool operator!=(const digest &rhs) const {
+			return !(*this == rhs);
+		}
+
+	private:
+		uint32_t h_[8] = {
+			0x6a09e667,
+			0xbb67ae85,
+			0x3c6ef372,
+			0xa54ff53a,
+			0x510e527f,
+			0x9b05688c,
+			0x1f83d9ab,
+			0x5be0cd19,
+		};
+	};
+
+public:
+	template <class In>
+	sha256(In first, In last) {
+		update(first, last);
+	}
+
+	sha256(const std::string &s) {
+		update(s);
+	}
+
+	sha256()                             = default;
+	sha256(const sha256 &other)          = default;
+	sha256 &operator=(const sha256 &rhs) = default;
+
+public:
+	template <class In>
+	sha256 &update(In first, In last) {
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
+		return *this;
+	}
+
+	sha256 &update(uint8_t byte) {
+		state_.block_[state_.index_++] = byte;
+
+		state_.length_ += 8;
+
+		if (state_.index_ == state::BlockSize) {
+			process_block(&state_, &digest_);
+		}
+
+		return *this;
+	}
+
+	sha256 &update(const std::string &s) {
+		update(s.data(), s.size());
+		return *this;
+	}
+
+	sha256 &update(const void *data, std::size_t size) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		state_.length_ += static_cast<uint64_t>(size) * 8;
+
+		// top up any partially filled block first
+		if (state_.index_ != 0) {
+			const std::size_t n = std::min<std::size_t>(size, state::BlockSize - state_.index_);
+			std::memcpy(&state_.block_[state_.index_], p, n);
+			state_.index_ += n;
+			p += n;
+			size -= n;
+
+			if (state_.index_ == state::BlockSize) {
+				process_block(&state_, &digest_);
+			}
+		}
+
+		// whole blocks can be transformed straight out of the caller's buffer
+		const std::size_t blocks = size / state::BlockSize;
+		if (blocks != 0) {
+			process_blocks(p, blocks, &digest_);
+			p += blocks * state::BlockSize;
+			size -= blocks * state::BlockSize;
+		}
+
+		// and only the tail needs to be buffered
+		std::memcpy(&state_.block_[state_.index_], p, size);
+		state_.index_ += size;
+		return *this;
+	}
+
+public:
+	void swap(sha256 &other) {
+		using std::swap;
+
+		swap(digest_, other.digest_);
+		swap(state_, other.state_);
+	}
+
+	void clear() {
+		digest_ = digest();
+		state_  = state();
+	}
+
+	static constexpr std::size_t StateSize = detail::hash_state_size(8);
+
+	/**
+	 * Checkpoints the hash of everything seen so far. Passing the result to
+	 * import_state (in this process or another) resumes hashing where it left
+	 * off, without having to feed the prefix through again. The format is
+	 * versioned and byte order independent, see hash_state.h
+	 */
+	std::array<uint8_t, StateSize> export_state() const {
+		return detail::export_hash_state<8>("S256", state_.length_, state_.index_, digest_.h_, state_.block_);
+	}
+
+	// returns false, leaving the hasher unchanged, if data isn't a valid SHA-256 state
+	bool import_state(const void *data, std::size_t size) {
+		state s;
+		digest d;
+		if (!detail::import_hash_state<8>("S256", data, size, &s.length_, &s.index_, d.h_, s.block_)) {
+			return false;
+		}
+
+		state_  = s;
+		digest_ = d;
+		return true;
+	}
+
+	digest finalize() const {
+		// make copies so this isn't a mutating operation
+		state s  = state_;
+		digest d = digest_;
+
+		s.block_[s.index_] = 0x80;
+
+		const size_t n = s.index_++;
+
+		if (n > 55) {
+			while (s.index_ < state::BlockSize) {
+				s.block_[s.index_++] = 0;
+			}
+
+			process_block(&s, &d);
+		}
+
+		while (s.index_ < 56) {
+			s.block_[s.index_++] = 0;
+		}
+
+		// Store the message length as the last 8 octets
+		s.block_[56] = (s.length_ >> 56) & 0xff;
+		s.block_[57] = (s.length_ >> 48) & 0xff;
+		s.block_[58] = (s.length_ >> 40) & 0xff;
+		s.block_[59] = (s.length_ >> 32) & 0xff;
+		s.block_[60] = (s.length_ >> 24) & 0xff;
+		s.block_[61] = (s.length_ >> 16) & 0xff;
+		s.block_[62] = (s.length_ >> 8) & 0xff;
+		s.block_[63] = (s.length_) & 0xff;
+		process_block(&s, &d);
+
+		return d;
+	}
+
+private:
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(*first++);
+		}
+	}
+
+	static void process_block(state *state, digest *digest) {
+		process_blocks(state->block_, 1, digest);
+		state->index_ = 0;
+	}
+
+	using process_function = void (*)(const uint8_t *, std::size_t, digest *);
+
+	static void process_blocks(const uint8_t *block, std::size_t count, digest *digest) {
+		static const process_function function = select_process_blocks();
+		function(block, count, digest);
+	}
+
+	static process_function select_process_blocks() {
+#ifdef HASH_X86_64_DISPATCH
+		if (detail::cpu().sha && detail::cpu().sse41) {
+			return process_blocks_sha_ni;
+		}
+#endif
+		return process_blocks_generic;
+	}
+
+#ifdef HASH_X86_64_DISPATCH
+	static void process_blocks_sha_ni(const uint8_t *block, std::size_t count, digest *digest) {
+		detail::sha256_ni_transform(digest->h_, block, count);
+	}
+#endif
+
+	static void process_blocks_generic(const uint8_t *block, std::size_t count, digest *digest) {
+		while (count--) {
+			transform(block, digest);
+			block += state::BlockSize;
+		}
+	}
+
+	static void transform(const uint8_t *block, digest *digest) {
+		const uint32_t *const K = detail::sha256_constants();
+
+		uint32_t W[64]; // Word sequence
+
+		//  Initialize the first 16 words in the array W
+		for (int t = 0; t < 16; ++t) {
+			W[t] = static_cast<uint32_t>(block[t * 4 + 0]) << 24;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 1]) << 16;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 2]) << 8;
+			W[t] |= static_cast<uint32_t>(block[t * 4 + 3]);
+		}
+
+		for (int t = 16; t < 64; ++t) {
+			const uint32_t s0 = bitwise::rotate_right(W[t - 15], 7) ^ bitwise::rotate_right(W[t - 15], 18) ^ (W[t - 15] >> 3);
+			const uint32_t s1 = bitwise::rotate_right(W[t - 2], 17) ^ bitwise::rotate_right(W[t - 2], 19) ^ (W[t - 2] >> 10);
+			W[t]              = W[t - 16] + s0 + W[t - 7] + s1;
+		}
+
+		uint32_t A = digest->h_[0];
+		uint32_t B = digest->h_[1];
+		uint32_t C = digest->h_[2];
+		uint32_t D = digest->h_[3];
+		uint32_t E = digest->h_[4];
+		uint32_t F = digest->h_[5];
+		uint32_t G = digest->h_[6];
+		uint32_t H = digest->h_[7];
+
+		for (int t = 0; t < 64; ++t) {
+			const uint32_t S1    = bitwise::rotate_right(E, 6) ^ bitwise::rotate_right(E, 11) ^ bitwise::rotate_right(E, 25);
+			const uint32_t ch    = (E & F) ^ (~E & G);
+			const uint32_t temp1 = H + S1 + ch + K[t] + W[t];
+			const uint32_t S0    = bitwise::rotate_right(A, 2) ^ bitwise::rotate_right(A, 13) ^ bitwise::rotate_right(A, 22);
+			const uint32_t maj   = (A & B) ^ (A & C) ^ (B & C);
+			const uint32_t temp2 = S0 + maj;
+
+			H = G;
+			G = F;
+			F = E;
+			E = D + temp1;
+			D = C;
+			C = B;
+			B = A;
+			A = temp1 + temp2;
+		}
+
+		digest->h_[0] += A;
+		digest->h_[1] += B;
+		digest->h_[2] += C;
+		digest->h_[3] += D;
+		digest->h_[4] += E;
+		digest->h_[5] += F;
+		digest->h_[6] += G;
+		digest->h_[7] += H;
+	}
+
+private:
+	state state_;
+	digest digest_;
+};
+
+}
+
+#endif
@@ -0,0 +1,466 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Evan Teran
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WYHASH_20261017_H_
+#define WYHASH_20261017_H_
+
+#include <array>
+#include <cpp-utilities/hash_detail.h>
+#include <cpp-utilities/hex.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace hash {
+
+namespace detail {
+
+// 64x64 -> 128-bit multiply, returning the low half in a and the high half in b
+inline void wy_multiply(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+	const unsigned __int128 r = static_cast<unsigned __int128>(*a) * *b;
+	*a                        = static_cast<uint64_t>(r);
+	*b                        = static_cast<uint64_t>(r >> 64);
+#else
+	const uint64_t ha = *a >> 32;
+	const uint64_t hb = *b >> 32;
+	const uint64_t la = static_cast<uint32_t>(*a);
+	const uint64_t lb = static_cast<uint32_t>(*b);
+
+	const uint64_t rh  = ha * hb;
+	const uint64_t rm0 = ha * lb;
+	const uint64_t rm1 = hb * la;
+	const uint64_t rl  = la * lb;
+	const uint64_t t   = rl + (rm0 << 32);
+
+	uint64_t carry = t < rl;
+	const uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+	wy_multiply(&a, &b);
+	return a ^ b;
+}
+
+// little endian loads, written out so that compilers turn them into a single mov
+inline uint64_t wy_read8(const uint8_t *p) {
+	return static_cast<uint64_t>(p[0]) |
+		   (static_cast<uint64_t>(p[1]) << 8) |
+		   (static_cast<uint64_t>(p[2]) << 16) |
+		   (static_cast<uint64_t>(p[3]) << 24) |
+		   (static_cast<uint64_t>(p[4]) << 32) |
+		   (static_cast<uint64_t>(p[5]) << 40) |
+		   (static_cast<uint64_t>(p[6]) << 48) |
+		   (static_cast<uint64_t>(p[7]) << 56);
+}
+
+inline uint64_t wy_read4(const uint8_t *p) {
+	return static_cast<uint64_t>(p[0]) |
+		   (static_cast<uint64_t>(p[1]) << 8) |
+		   (static_cast<uint64_t>(p[2]) << 16) |
+		   (static_cast<uint64_t>(p[3]) << 24);
+}
+
+// reads 1-3 bytes
+inline uint64_t wy_read3(const uint8_t *p, std::size_t k) {
+	return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+constexpr uint64_t wy_secret0 = 0x2d358dccaa6c78a5ull;
+constexpr uint64_t wy_secret1 = 0x8bb84b93962eacc9ull;
+constexpr uint64_t wy_secret2 = 0x4b33a62ed433d4a3ull;
+constexpr uint64_t wy_secret3 = 0x4d5a2da51de1aa47ull;
+
+inline uint64_t wy_seed(uint64_t seed) {
+	return seed ^ wy_mix(seed ^ wy_secret0, wy_secret1);
+}
+
+// reads the final 1-16 bytes (or none) of a message of up to 16 bytes
+inline void wy_read_short(const uint8_t *p, std::size_t len, uint64_t *a, uint64_t *b) {
+	if (len >= 4) {
+		*a = (wy_read4(p) << 32) | wy_read4(p + ((len >> 3) << 2));
+		*b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - ((len >> 3) << 2));
+	} else if (len > 0) {
+		*a = wy_read3(p, len);
+		*b = 0;
+	} else {
+		*a = 0;
+		*b = 0;
+	}
+}
+
+inline uint64_t wy_finish(uint64_t a, uint64_t b, uint64_t seed, uint64_t len) {
+	a ^= wy_secret1;
+	b ^= seed;
+	wy_multiply(&a, &b);
+	return wy_mix(a ^ wy_secret0 ^ len, b ^ wy_secret1);
+}
+
+// the whole algorithm for a contiguous buffer
+inline uint64_t wyhash_buffer(const uint8_t *p, std::size_t len, uint64_t seed) {
+	seed = wy_seed(seed);
+
+	uint64_t a;
+	uint64_t b;
+	if (len <= 16) {
+		wy_read_short(p, len, &a, &b);
+	} else {
+		std::size_t i = len;
+		if (i > 48) {
+			uint64_t see1 = seed;
+			uint64_t see2 = seed;
+			do {
+				seed = wy_mix(wy_read8(p) ^ wy_secret1, wy_read8(p + 8) ^ seed);
+				see1 = wy_mix(wy_read8(p + 16) ^ wy_secret2, wy_read8(p + 24) ^ see1);
+				see2 = wy_mix(wy_read8(p + 32) ^ wy_secret3, wy_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16) {
+			seed = wy_mix(wy_read8(p) ^ wy_secret1, wy_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		a = wy_read8(p + i - 16);
+		b = wy_read8(p + i - 8);
+	}
+
+	return wy_finish(a, b, seed, len);
+}
+
+}
+
+/*
+ * A fast, high quality non-cryptographic 64-bit hash for hash tables,
+ * sharding and similar. This is wyhash (final version 4) by Wang Yi: input
+ * is consumed 48 bytes at a time by three independent 64x64->128-bit
+ * multiply-mix lanes, and inputs of up to 16 bytes take a branch light path
+ * of their own.
+ *
+ * NOTE: this is NOT a cryptographic hash, don't use it where an attacker
+ * choosing the input matters unless you also pick a secret seed.
+ */
+class wyhash {
+public:
+	struct state {
+		static constexpr int StripeSize = 48;
+		static constexpr int Overlap    = 16;
+
+		// the bytes which haven't been consumed yet live at block_ + Overlap,
+		// preceded by the last Overlap bytes which have, since the final mix
+		// may need to look back at them
+		uint8_t block_[Overlap + StripeSize];
+		uint64_t length_   = 0;
+		std::size_t index_ = 0;
+		uint64_t seed_     = 0;
+		uint64_t see1_     = 0;
+		uint64_t see2_     = 0;
+	};
+
+	class digest {
+		friend class wyhash;
+
+	public:
+		static constexpr std::size_t HexSize = 16;
+
+		// returns nullptr if [first, last) is too small, no terminator is written
+		char *to_chars(char *first, char *last) const {
+			if (static_cast<std::size_t>(last - first) < HexSize) {
+				return nullptr;
+			}
+
+			detail::hex_encode_value<8>(h_, first);
+			return first + HexSize;
+		}
+
+		std::array<char, HexSize> to_chars() const {
+			std::array<char, HexSize> str;
+			to_chars(str.data(), str.data() + str.size());
+			return str;
+		}
+
+		std::string to_string() const {
+			const auto str = to_chars();
+			return std::string(str.data(), str.size());
+		}
+
+		std::array<uint8_t, 8> bytes() const {
+			std::array<uint8_t, 8> b;
+			for (unsigned i = 0; i < 8; ++i) {
+				b[i] = static_cast<uint8_t>(h_ >> (i * 8));
+			}
+			return b;
+		}
+
+		uint64_t value() const {
+			return h_;
+		}
+
+		bool operator==(const digest &rhs) const {
+			return h_ == rhs.h_;
+		}
+
+		bool operator!=(const digest &rhs) const {
+			return !(*this == rhs);
+		}
+
+	private:
+		uint64_t h_ = 0;
+	};
+
+public:
+	template <class In>
+	wyhash(In first, In last, uint64_t seed = 0)
+		: wyhash(seed) {
+		update(first, last);
+	}
+
+	wyhash(const std::string &s, uint64_t seed = 0)
+		: wyhash(seed) {
+		update(s);
+	}
+
+	// without this, wyhash(str, seed) would take the seed as a length. It's
+	// a template so that wyhash(0) still means a seed rather than a string
+	template <class Char, class = typename std::enable_if<std::is_same<Char, char>::value>::type>
+	wyhash(const Char *s, uint64_t seed = 0)
+		: wyhash(seed) {
+		update(s, std::strlen(s));
+	}
+
+	wyhash(const void *data, std::size_t size, uint64_t seed = 0)
+		: wyhash(seed) {
+		update(data, size);
+	}
+
+	explicit wyhash(uint64_t seed) {
+		reset(seed);
+	}
+
+	wyhash()
+		: wyhash(0) {
+	}
+
+	wyhash(const wyhash &other)          = default;
+	wyhash &operator=(const wyhash &rhs) = default;
+
+public:
+	template <class In>
+	wyhash &update(In first, In last) {
+		update_range(first, last, detail::is_contiguous_byte_iterator<In>());
+		return *this;
+	}
+
+	wyhash &update(uint8_t byte) {
+		// a full buffer can be consumed now that we know more input follows it
+		if (state_.index_ == state::StripeSize) {
+			process_buffered_stripe(&state_);
+		}
+
+		state_.block_[state::Overlap + state_.index_++] = byte;
+		++state_.length_;
+		return *this;
+	}
+
+	wyhash &update(const std::string &s) {
+		return update(s.data(), s.size());
+	}
+
+	wyhash &update(const void *data, std::size_t size) {
+		auto p = static_cast<const uint8_t *>(data);
+
+		state_.length_ += size;
+
+		// a stripe is only consumed once we know more input follows it
+		if (state_.index_ + size <= state::StripeSize) {
+			std::memcpy(&state_.block_[state::Overlap + state_.index_], p, size);
+			state_.index_ += size;
+			return *this;
+		}
+
+		if (state_.index_ != 0) {
+			const std::size_t n = state::StripeSize - state_.index_;
+			std::memcpy(&state_.block_[state::Overlap + state_.index_], p, n);
+			p += n;
+			size -= n;
+
+			process_buffered_stripe(&state_);
+		}
+
+		if (size > state::StripeSize) {
+			while (size > state::StripeSize) {
+				process_stripe(&state_, p);
+				p += state::StripeSize;
+				size -= state::StripeSize;
+			}
+
+			std::memcpy(state_.block_, p - state::Overlap, state::Overlap);
+		}
+
+		std::memcpy(&state_.block_[state::Overlap], p, size);
+		state_.index_ = size;
+		return *this;
+	}
+
+public:
+	void swap(wyhash &other) {
+		using std::swap;
+		swap(state_, other.state_);
+		swap(seed_, other.seed_);
+	}
+
+	void clear() {
+		reset(seed_);
+	}
+
+	digest finalize() const {
+		const uint8_t *p   = &state_.block_[state::Overlap];
+		const uint64_t len = state_.length_;
+		uint64_t seed      = state_.seed_;
+		uint64_t a;
+		uint64_t b;
+
+		if (len <= 16) {
+			detail::wy_read_short(p, static_cast<std::size_t>(len), &a, &b);
+		} else {
+			std::size_t i = state_.index_;
+			if (len > state::StripeSize) {
+				seed ^= state_.see1_ ^ state_.see2_;
+			}
+
+			while (i > 16) {
+				seed = detail::wy_mix(detail::wy_read8(p) ^ detail::wy_secret1, detail::wy_read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+
+			// NOTE: may reach back into the overlap
+			a = detail::wy_read8(p + i - 16);
+			b = detail::wy_read8(p + i - 8);
+		}
+
+		digest d;
+		d.h_ = detail::wy_finish(a, b, seed, len);
+		return d;
+	}
+
+	/**
+	 * One shot hash of [data, data + size), this avoids the buffering of the
+	 * streaming interface and is what wyhash_hasher uses.
+	 */
+	static uint64_t hash_bytes(const void *data, std::size_t size, uint64_t seed = 0) {
+		return detail::wyhash_buffer(static_cast<const uint8_t *>(data), size, seed);
+	}
+
+private:
+	void reset(uint64_t seed) {
+		seed_        = seed;
+		state_       = state();
+		state_.seed_ = detail::wy_seed(seed);
+		state_.see1_ = state_.seed_;
+		state_.see2_ = state_.seed_;
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::true_type) {
+		if (first != last) {
+			update(&*first, static_cast<std::size_t>(last - first));
+		}
+	}
+
+	template <class In>
+	void update_range(In first, In last, std::false_type) {
+		while (first != last) {
+			update(static_cast<uint8_t>(*first++));
+		}
+	}
+
+	static void process_stripe(state *state, const uint8_t *p) {
+		state->seed_ = detail::wy_mix(detail::wy_read8(p) ^ detail::wy_secret1, detail::wy_read8(p + 8) ^ state->seed_);
+		state->see1_ = detail::wy_mix(detail::wy_read8(p + 16) ^ detail::wy_secret2, detail::wy_read8(p + 24) ^ state->see1_);
+		state->see2_ = detail::wy_mix(detail::wy_read8(p + 32) ^ detail::wy_secret3, detail::wy_read8(p + 40) ^ state->see2_);
+	}
+
+	static void process_buffered_stripe(state *state) {
+		process_stripe(state, &state->block_[state::Overlap]);
+		std::memcpy(state->block_, &state->block_[state::StripeSize], state::Overlap);
+		state->index_ = 0;
+	}
+
+private:
+	state state_;
+	uint64_t seed_ = 0;
+};
+
+/**
+ * A hash functor built on wyhash, suitable as the Hash parameter of
+ * std::unordered_map, lru_cache and friends:
+ *
+ *     std::unordered_map<std::string, int, hash::wyhash_hasher> map;
+ *
+ * Strings are hashed by content, integers and enums with a single
+ * multiply-mix.
+ */
+struct wyhash_hasher {
+	uint64_t seed = 0;
+
+	std::size_t operator()(const std::string &s) const {
+		return static_cast<std::size_t>(wyhash::hash_bytes(s.data(), s.size(), seed));
+	}
+
+	std::size_t operator()(const char *s) const {
+		return static_cast<std::size_t>(wyhash::hash_bytes(s, std::strlen(s), seed));
+	}
+
+#if __cplusplus >= 201703L
+	std::size_t operator()(std::string_view s) const {
+		return static_cast<std::size_t>(wyhash::hash_bytes(s.data(), s.size(), seed));
+	}
+#endif
+
+	template <class T, class = typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+	std::size_t operator()(T value) const {
+		const uint64_t v = static_cast<uint64_t>(value);
+		return static_cast<std::size_t>(detail::wy_mix(v ^ detail::wy_secret0, seed ^ detail::wy_secret1));
+	}
+};
+
+}
+
+#endif
@@ -1,9 +1,30 @@
 
+#include "cpp-utilities/crc.h"
 #include "cpp-utilities/crc32.h"
+#include "cpp-utilities/chunker.h"
+#include "cpp-utilities/crc32c.h"
+#include "cpp-utilities/hash_file.h"
+#include "cpp-utilities/hex.h"
+#include "cpp-utilities/hmac.h"
 #include "cpp-utilities/md5.h"
+#include "cpp-utilities/md5_batch.h"
+#include "cpp-utilities/merkle.h"
+#include "cpp-utilities/multi_hasher.h"
+#include "cpp-utilities/parallel_crc32.h"
 #include "cpp-utilities/sha1.h"
+#include "cpp-utilities/sha1_batch.h"
+#include "cpp-utilities/sha256.h"
+#include "cpp-utilities/wyhash.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <list>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 int main() {
 
@@ -45,6 +66,40 @@ int main() {
 		auto d8 = hash::sha1({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}).finalize();
 		std::cout << d8.to_string() << std::endl;
 		assert(d8.to_string() == "c5391e308af25b42d5934d6a201a34e898d255c6");
+
+		// long enough to run many blocks through the (possibly SHA-NI) bulk transform
+		auto d9 = hash::sha1(std::string(1000000, 'a')).finalize();
+		std::cout << d9.to_string() << std::endl;
+		assert(d9.to_string() == "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+	}
+
+	// --------------------- Test SHA-256 ---------------------
+	{
+		const std::string s = "abc";
+		hash::sha256 sha256(s.begin(), s.end());
+
+		auto d1 = sha256.finalize();
+		std::cout << d1.to_string() << std::endl;
+		assert(d1.to_string() == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+		auto d2 = hash::sha256().finalize();
+		std::cout << d2.to_string() << std::endl;
+		assert(d2.to_string() == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+		auto d3 = hash::sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").finalize();
+		std::cout << d3.to_string() << std::endl;
+		assert(d3.to_string() == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+		auto d4 = hash::sha256(std::string(1000000, 'a')).finalize();
+		std::cout << d4.to_string() << std::endl;
+		assert(d4.to_string() == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+		// finalize doesn't disturb the running state
+		sha256.update('d');
+		assert(sha256.finalize() == hash::sha256("abcd").finalize());
+
+		auto b = d1.bytes();
+		assert(b[0] == 0xba && b[1] == 0x78 && b[31] == 0xad);
 	}
 
 	// --------------------- Test MD5 ---------------------
@@ -87,6 +142,41 @@ int main() {
 		assert(d8.to_string() == "70903e79b7575e3f4e7ffa15c2608ac7");
 	}
 
+	// --------------------- Test bulk updates ---------------------
+	{
+		std::vector<uint8_t> buffer(1000);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<uint8_t>(i * 131 + (i >> 7));
+		}
+
+		// feed the same data in various sized pieces so that partial blocks
+		// get topped up, and whole blocks get hashed directly from the buffer
+		for (size_t piece : {1, 3, 63, 64, 65, 127, 128, 200, 1000}) {
+			hash::md5 md5_bulk;
+			hash::sha1 sha1_bulk;
+			hash::sha256 sha256_bulk;
+			for (size_t offset = 0; offset < buffer.size(); offset += piece) {
+				const size_t n = std::min(piece, buffer.size() - offset);
+				md5_bulk.update(&buffer[offset], n);
+				sha1_bulk.update(buffer.begin() + offset, buffer.begin() + offset + n);
+				sha256_bulk.update(&buffer[offset], n);
+			}
+
+			hash::md5 md5_bytewise;
+			hash::sha1 sha1_bytewise;
+			hash::sha256 sha256_bytewise;
+			for (uint8_t byte : buffer) {
+				md5_bytewise.update(byte);
+				sha1_bytewise.update(byte);
+				sha256_bytewise.update(byte);
+			}
+
+			assert(md5_bulk.finalize() == md5_bytewise.finalize());
+			assert(sha1_bulk.finalize() == sha1_bytewise.finalize());
+			assert(sha256_bulk.finalize() == sha256_bytewise.finalize());
+		}
+	}
+
 	// --------------------- Test CRC32 ---------------------
 	{
 		const std::string s = "Hello World";
@@ -126,4 +216,659 @@ int main() {
 		std::cout << d8.to_string() << std::endl;
 		assert(d8.to_string() == "2520577b");
 	}
+
+	// --------------------- Test CRC variants ---------------------
+	{
+		auto d1 = hash::crc16_arc("123456789").finalize();
+		std::cout << d1.to_string() << std::endl;
+		assert(d1.to_string() == "bb3d");
+
+		auto d2 = hash::crc16_ccitt_false("123456789").finalize();
+		std::cout << d2.to_string() << std::endl;
+		assert(d2.to_string() == "29b1");
+
+		auto d3 = hash::crc32_bzip2("123456789").finalize();
+		std::cout << d3.to_string() << std::endl;
+		assert(d3.to_string() == "fc891918");
+
+		auto d4 = hash::crc64_xz("123456789").finalize();
+		std::cout << d4.to_string() << std::endl;
+		assert(d4.to_string() == "995dc9bbdf1939fa");
+
+		// the slicing kernels must agree with the byte at a time path
+		std::vector<uint8_t> buffer(1024);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<uint8_t>(i * 131 + (i >> 7));
+		}
+
+		for (size_t length = 0; length < 100; ++length) {
+			hash::crc32 crc32_bulk(buffer.data(), buffer.data() + length);
+			hash::crc16_ccitt_false crc16_bulk(buffer.data(), buffer.data() + length);
+			hash::crc64_xz crc64_bulk(buffer.data(), buffer.data() + length);
+
+			hash::crc32 crc32_bytewise;
+			hash::crc16_ccitt_false crc16_bytewise;
+			hash::crc64_xz crc64_bytewise;
+			for (size_t i = 0; i < length; ++i) {
+				crc32_bytewise.update(buffer[i]);
+				crc16_bytewise.update(buffer[i]);
+				crc64_bytewise.update(buffer[i]);
+			}
+
+			assert(crc32_bulk.finalize() == crc32_bytewise.finalize());
+			assert(crc16_bulk.finalize() == crc16_bytewise.finalize());
+			assert(crc64_bulk.finalize() == crc64_bytewise.finalize());
+		}
+	}
+
+	// --------------------- Test CRC combine ---------------------
+	{
+		const std::string a = "Hello ";
+		const std::string b = "World";
+
+		auto d1 = hash::crc32_combine(hash::crc32(a).finalize(), hash::crc32(b).finalize(), b.size());
+		std::cout << d1.to_string() << std::endl;
+		assert(d1.to_string() == "4a17b156");
+
+		auto d2 = hash::crc32_combine(hash::crc32(a).finalize(), hash::crc32().finalize(), 0);
+		assert(d2 == hash::crc32(a).finalize());
+
+		// variants where the initial value and final xor differ
+		auto d3 = hash::crc16_ccitt_false::combine(hash::crc16_ccitt_false("1234").finalize(), hash::crc16_ccitt_false("56789").finalize(), 5);
+		assert(d3.to_string() == "29b1");
+
+		auto d4 = hash::crc32_bzip2::combine(hash::crc32_bzip2("12345678").finalize(), hash::crc32_bzip2("9").finalize(), 1);
+		assert(d4.to_string() == "fc891918");
+
+		auto d5 = hash::crc32c::combine(hash::crc32c("Hello ").finalize(), hash::crc32c("World").finalize(), 5);
+		assert(d5.to_string() == "691daa2f");
+	}
+
+	// --------------------- Test parallel CRC32 ---------------------
+	{
+		std::vector<uint8_t> buffer(4 * 1024 * 1024 + 12345);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<uint8_t>(i * 2654435761u >> 13);
+		}
+
+		const auto expected = hash::crc32(buffer.data(), buffer.data() + buffer.size()).finalize();
+
+		thread_pool pool(4);
+		for (size_t chunk_size : {0, 1000, 65536, 1024 * 1024, 8 * 1024 * 1024}) {
+			auto d = hash::parallel_crc32(buffer.data(), buffer.size(), pool, chunk_size);
+			assert(d == expected);
+		}
+
+		assert(hash::parallel_crc<hash::crc32c>(buffer.data(), buffer.size(), pool, 100000) == hash::crc32c(buffer.data(), buffer.data() + buffer.size()).finalize());
+	}
+
+	// --------------------- Test CRC32C ---------------------
+	{
+		const std::string s = "Hello World";
+		hash::crc32c crc32c(s.begin(), s.end());
+
+		auto d1 = crc32c.finalize();
+		std::cout << d1.to_string() << std::endl;
+		assert(d1.to_string() == "691daa2f");
+
+		auto d2 = hash::crc32c().finalize();
+		std::cout << d2.to_string() << std::endl;
+		assert(d2.to_string() == "00000000");
+
+		auto d3 = hash::crc32c("123456789").finalize();
+		std::cout << d3.to_string() << std::endl;
+		assert(d3.to_string() == "e3069283");
+
+		auto d4 = hash::crc32c("The quick brown fox jumps over the lazy dog").finalize();
+		std::cout << d4.to_string() << std::endl;
+		assert(d4.to_string() == "22620404");
+
+		// the accelerated bulk path must agree with the byte at a time path for
+		// every length and alignment, including ones which use the 3-way streams
+		std::vector<uint8_t> buffer(3 * 8192 * 2 + 3 * 256 * 3 + 64);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<uint8_t>(i * 131 + (i >> 7));
+		}
+
+		for (size_t offset = 0; offset < 8; ++offset) {
+			for (size_t length : {0, 1, 7, 8, 63, 767, 768, 769, 3 * 8192, 3 * 8192 + 3 * 256 + 13, 3 * 8192 * 2 + 3 * 256 * 3 + 56}) {
+				hash::crc32c bulk;
+				bulk.update(&buffer[offset], length);
+
+				hash::crc32c bytewise;
+				for (size_t i = 0; i < length; ++i) {
+					bytewise.update(buffer[offset + i]);
+				}
+
+				assert(bulk.finalize() == bytewise.finalize());
+			}
+		}
+	}
+
+	// --------------------- Test batch hashing ---------------------
+	{
+		// a mix of lengths, including ones which need an extra padding block and
+		// a count which leaves a partial group of lanes for the scalar path
+		std::vector<std::string> messages;
+		for (size_t i = 0; i < 203; ++i) {
+			std::string message((i * 37) % 300, '\0');
+			for (size_t j = 0; j < message.size(); ++j) {
+				message[j] = static_cast<char>(i * 7 + j * 13);
+			}
+			messages.push_back(message);
+		}
+
+		auto md5s = hash::md5_batch(messages);
+		assert(md5s.size() == messages.size());
+		for (size_t i = 0; i < messages.size(); ++i) {
+			assert(md5s[i] == hash::md5(messages[i]).finalize());
+		}
+
+		auto sha1s = hash::sha1_batch(messages);
+		assert(sha1s.size() == messages.size());
+		for (size_t i = 0; i < messages.size(); ++i) {
+			assert(sha1s[i] == hash::sha1(messages[i]).finalize());
+		}
+
+		std::array<std::string, 3> small = {{"", "abc", "The quick brown fox jumps over the lazy dog"}};
+		auto d1                          = hash::md5_batch(small);
+		std::cout << d1[2].to_string() << std::endl;
+		assert(d1[0].to_string() == "d41d8cd98f00b204e9800998ecf8427e");
+		assert(d1[2].to_string() == "9e107d9d372bb6826bd81d3542a419d6");
+
+		auto d2 = hash::sha1_batch(small);
+		std::cout << d2[1].to_string() << std::endl;
+		assert(d2[1].to_string() == "a9993e364706816aba3e25717850c26c9cd0d89d");
+		assert(d2[2].to_string() == "2fd4e1c67a2d28fced849ee1bb76e7391b93eb12");
+
+		assert(hash::md5_batch(std::vector<std::string>()).empty());
+	}
+
+	// --------------------- Test wyhash ---------------------
+	{
+		// the reference implementation's test vectors, which use the index as the seed
+		const char *messages[] = {
+			"",
+			"a",
+			"abc",
+			"message digest",
+			"abcdefghijklmnopqrstuvwxyz",
+			"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+			"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+		};
+
+		const char *expected[] = {
+			"93228a4de0eec5a2",
+			"c5bac3db178713c4",
+			"a97f2f7b1d9b3314",
+			"786d1f1df3801df4",
+			"dca5a8138ad37c87",
+			"b9e734f117cfaf70",
+			"6cc5eab49a92d617",
+		};
+
+		for (size_t i = 0; i < 7; ++i) {
+			auto d = hash::wyhash(messages[i], i).finalize();
+			std::cout << d.to_string() << std::endl;
+			assert(d.to_string() == expected[i]);
+			assert(d.value() == hash::wyhash::hash_bytes(messages[i], std::strlen(messages[i]), i));
+		}
+
+		// streaming in pieces of any size must agree with the one shot hash,
+		// especially around the 16 byte short path and 48 byte stripes
+		std::vector<uint8_t> buffer(400);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<uint8_t>(i * 131 + (i >> 7));
+		}
+
+		for (size_t length = 0; length < buffer.size(); ++length) {
+			const uint64_t one_shot = hash::wyhash::hash_bytes(buffer.data(), length, 42);
+			assert(hash::wyhash(buffer.data(), length, 42).finalize().value() == one_shot);
+			for (size_t piece : {1, 15, 16, 17, 47, 48, 49, 400}) {
+				hash::wyhash wyhash(42);
+				for (size_t offset = 0; offset < length; offset += piece) {
+					wyhash.update(&buffer[offset], std::min(piece, length - offset));
+				}
+				assert(wyhash.finalize().value() == one_shot);
+			}
+		}
+
+		std::unordered_map<std::string, int, hash::wyhash_hasher> map;
+		map["hello"] = 1;
+		map["world"] = 2;
+		assert(map.at("hello") == 1 && map.at("world") == 2);
+
+		assert(hash::wyhash_hasher{1}(std::string("key")) != hash::wyhash_hasher{2}(std::string("key")));
+		assert(hash::wyhash_hasher{}("key") == hash::wyhash_hasher{}(std::string("key")));
+	}
+
+	// --------------------- Test constexpr hashing ---------------------
+	{
+		constexpr auto c1 = hash::crc32("123456789").finalize();
+		static_assert(c1.value() == 0xcbf43926, "crc32 should fold at compile time");
+		static_assert(hash::crc32c("123456789").finalize().value() == 0xe3069283, "crc32c should fold at compile time");
+		static_assert(hash::crc64_xz("123456789").finalize().value() == 0x995dc9bbdf1939fa, "crc64 should fold at compile time");
+		assert(c1 == hash::crc32(std::string("123456789")).finalize());
+
+		// hashed switch labels
+		auto classify = [](const std::string &name) {
+			switch (hash::crc32(name).finalize().value()) {
+			case hash::crc32("Order").finalize().value():
+				return 1;
+			case hash::crc32("Cancel").finalize().value():
+				return 2;
+			default:
+				return 0;
+			}
+		};
+
+		assert(classify("Order") == 1);
+		assert(classify("Cancel") == 2);
+		assert(classify("Unknown") == 0);
+
+		constexpr auto m1 = hash::md5("The quick brown fox jumps over the lazy dog").finalize();
+		static_assert(m1 != hash::md5("The quick brown fox jumps over the lazy cog").finalize(), "md5 should fold at compile time");
+		std::cout << m1.to_string() << std::endl;
+		assert(m1.to_string() == "9e107d9d372bb6826bd81d3542a419d6");
+
+		// long enough to need two blocks
+		constexpr auto s1 = hash::sha1("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA").finalize();
+		static_assert(s1 == hash::sha1("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA").finalize(), "sha1 should fold at compile time");
+		std::cout << s1.to_string() << std::endl;
+		assert(s1.to_string() == "e8d6ea5c627fc8676fa662677b028640844dc35c");
+
+		// a literal 0 is still a byte, not a string
+		const uint8_t zero[1] = {0};
+		assert(hash::crc32().update(0).finalize() == hash::crc32().update(zero, sizeof(zero)).finalize());
+		assert(hash::crc32c().update(0).finalize() == hash::crc32c().update(zero, sizeof(zero)).finalize());
+		assert(hash::md5().update(0).finalize() == hash::md5().update(zero, sizeof(zero)).finalize());
+		assert(hash::sha1().update(0).finalize() == hash::sha1().update(zero, sizeof(zero)).finalize());
+
+		// mutable buffers and pointers are C strings
+		char buffer[16] = "Order";
+		const char *pointer = buffer;
+		assert(hash::crc32(buffer).finalize() == hash::crc32("Order").finalize());
+		assert(hash::md5(pointer).finalize() == hash::md5("Order").finalize());
+
+		// embedded NULs are hashed, whether in a literal or a braced list
+		const std::string embedded("a\0b", 3);
+		static_assert(hash::crc32("a\0b").finalize() != hash::crc32("a").finalize(), "literals should keep embedded NULs");
+		assert(hash::crc32("a\0b").finalize() == hash::crc32(embedded).finalize());
+		assert(hash::crc32({'a', 0, 'b'}).finalize() == hash::crc32(embedded).finalize());
+		assert(hash::crc32c("a\0b").finalize() == hash::crc32c(embedded).finalize());
+		assert(hash::crc32c({'a', 0, 'b'}).finalize() == hash::crc32c(embedded).finalize());
+		assert(hash::md5("a\0b").finalize() == hash::md5(embedded).finalize());
+		assert(hash::md5({'a', 0, 'b'}).finalize() == hash::md5(embedded).finalize());
+		assert(hash::sha1("a\0b").finalize() == hash::sha1(embedded).finalize());
+		assert(hash::sha1({'a', 0, 'b'}).finalize() == hash::sha1(embedded).finalize());
+
+#if __cplusplus >= 201703L
+		static_assert(hash::crc32(std::string_view("123456789")).finalize().value() == 0xcbf43926, "string_view should fold at compile time");
+#endif
+	}
+
+	// --------------------- Test digest formatting ---------------------
+	{
+		const std::string messages[] = {"", "a", "abc", "message digest", "The quick brown fox jumps over the lazy dog"};
+
+		for (const std::string &message : messages) {
+			const auto m  = hash::md5(message).finalize();
+			const auto s1 = hash::sha1(message).finalize();
+			const auto s2 = hash::sha256(message).finalize();
+			const auto c1 = hash::crc32(message).finalize();
+			const auto c2 = hash::crc32c(message).finalize();
+			const auto c3 = hash::crc16_arc(message).finalize();
+			const auto w  = hash::wyhash(message).finalize();
+
+			const auto a1 = m.to_chars();
+			const auto a2 = s2.to_chars();
+			const auto a3 = c3.to_chars();
+			assert(std::string(a1.data(), a1.size()) == m.to_string());
+			assert(std::string(a2.data(), a2.size()) == s2.to_string());
+			assert(std::string(a3.data(), a3.size()) == c3.to_string());
+			assert(a3.size() == 4);
+
+			char buffer[64];
+			assert(s1.to_chars(buffer, buffer + sizeof(buffer)) == buffer + 40);
+			assert(std::string(buffer, 40) == s1.to_string());
+			assert(c1.to_chars(buffer, buffer + sizeof(buffer)) == buffer + 8);
+			assert(std::string(buffer, 8) == c1.to_string());
+			assert(c2.to_chars(buffer, buffer + sizeof(buffer)) == buffer + 8);
+			assert(std::string(buffer, 8) == c2.to_string());
+			assert(w.to_chars(buffer, buffer + sizeof(buffer)) == buffer + 16);
+			assert(std::string(buffer, 16) == w.to_string());
+
+			// too small, nothing is written
+			assert(s2.to_chars(buffer, buffer + 63) == nullptr);
+			assert(c1.to_chars(buffer, buffer + 7) == nullptr);
+		}
+
+		assert(hash::crc32(std::string("123456789")).finalize().to_string() == "cbf43926");
+		assert(hash::wyhash(std::string()).finalize().to_string() == "93228a4de0eec5a2");
+
+		std::vector<hash::sha1::digest> digests;
+		std::string expected;
+		std::string separated;
+		for (const std::string &message : messages) {
+			digests.push_back(hash::sha1(message).finalize());
+			expected += digests.back().to_string();
+			separated += digests.back().to_string() + "\n";
+		}
+
+		std::vector<char> out(separated.size());
+		const hash::sha1::digest *first = digests.data();
+		const hash::sha1::digest *last  = digests.data() + digests.size();
+
+		char *end = hash::to_chars(first, last, out.data(), out.data() + out.size());
+		assert(end == out.data() + expected.size());
+		assert(std::string(out.data(), end) == expected);
+
+		end = hash::to_chars(first, last, out.data(), out.data() + out.size(), '\n');
+		assert(end == out.data() + out.size());
+		assert(std::string(out.data(), end) == separated);
+
+		assert(hash::to_chars(first, last, out.data(), out.data() + out.size() - 1, '\n') == nullptr);
+	}
+
+	// --------------------- Test resumable state ---------------------
+	{
+		std::string message;
+		for (int i = 0; i < 1000; ++i) {
+			message += static_cast<char>(i * 7);
+		}
+
+		for (std::size_t split : {0, 1, 55, 63, 64, 65, 200, 1000}) {
+			hash::md5 m(message.begin(), message.begin() + split);
+			hash::sha1 s1(message.begin(), message.begin() + split);
+			hash::sha256 s2(message.begin(), message.begin() + split);
+
+			const auto ms  = m.export_state();
+			const auto s1s = s1.export_state();
+			const auto s2s = s2.export_state();
+
+			hash::md5 m2;
+			hash::sha1 s12;
+			hash::sha256 s22;
+			assert(m2.import_state(ms.data(), ms.size()));
+			assert(s12.import_state(s1s.data(), s1s.size()));
+			assert(s22.import_state(s2s.data(), s2s.size()));
+
+			m2.update(message.begin() + split, message.end());
+			s12.update(message.begin() + split, message.end());
+			s22.update(message.begin() + split, message.end());
+
+			assert(m2.finalize() == hash::md5(message).finalize());
+			assert(s12.finalize() == hash::sha1(message).finalize());
+			assert(s22.finalize() == hash::sha256(message).finalize());
+		}
+
+		hash::sha1 s("abc");
+		const auto good = s.export_state();
+		assert(good.size() == hash::sha1::StateSize);
+
+		// wrong algorithm, truncated, corrupted
+		hash::md5 m;
+		assert(!m.import_state(good.data(), good.size()));
+		assert(!s.import_state(good.data(), good.size() - 1));
+
+		auto bad = good;
+		bad[20] ^= 1;
+		assert(!s.import_state(bad.data(), bad.size()));
+
+		bad    = good;
+		bad[4] = 2;
+		assert(!s.import_state(bad.data(), bad.size()));
+
+		// failed imports leave the hasher alone
+		assert(s.finalize() == hash::sha1("abc").finalize());
+	}
+
+	// --------------------- Test HMAC ---------------------
+	{
+		// RFC 2202 and RFC 4231
+		hash::hmac<hash::md5> m("Jefe");
+		hash::hmac<hash::sha1> s1("Jefe");
+		hash::hmac<hash::sha256> s2("Jefe");
+
+		const std::string message = "what do ya want for nothing?";
+		std::cout << s1.sign(message).to_string() << std::endl;
+		assert(m.sign(message).to_string() == "750c783e6ab0b503eaa86e310a5db738");
+		assert(s1.sign(message).to_string() == "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79");
+		assert(s2.sign(message).to_string() == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+		const std::string key1(20, '\x0b');
+		assert(hash::hmac<hash::sha1>(key1).sign("Hi There").to_string() == "b617318655057264e28bc0b6fb378c8ef146be00");
+		assert(hash::hmac<hash::sha256>(key1).sign("Hi There").to_string() == "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+		// keys longer than a block are hashed first
+		const std::string key2(80, '\xaa');
+		const std::string message2 = "Test Using Larger Than Block-Size Key - Hash Key First";
+		assert(hash::hmac<hash::md5>(key2).sign(message2).to_string() == "6b1ab7fe4bd7bf8f0b62e6ce61b9d0cd");
+		assert(hash::hmac<hash::sha1>(key2).sign(message2).to_string() == "aa4ae5e15272d00e95705637ce8a3b55ed402112");
+
+		// streaming gives the same answer, and finalize doesn't disturb it
+		s1.update(message.begin(), message.begin() + 10);
+		assert(s1.finalize() == s1.sign(message.substr(0, 10)));
+		s1.update(message.begin() + 10, message.end());
+		assert(s1.finalize() == s1.sign(message));
+		s1.clear();
+		s1.update(message);
+		assert(s1.finalize() == s1.sign(message));
+
+		assert(s2.verify(message, s2.sign(message)));
+		assert(!s2.verify(message + "!", s2.sign(message)));
+	}
+
+	// --------------------- Test Merkle tree ---------------------
+	{
+		using tree = hash::merkle_tree<hash::sha256>;
+
+		std::string data(1000, '\0');
+		for (std::size_t i = 0; i < data.size(); ++i) {
+			data[i] = static_cast<char>(i * 31 + 7);
+		}
+
+		// three leaves, the last one is carried up a level
+		const tree t3(data.data(), 300, 100);
+		assert(t3.leaves() == 3);
+		assert(t3.root() == tree::hash_node(tree::hash_node(tree::hash_leaf(&data[0], 100), tree::hash_leaf(&data[100], 100)), tree::hash_leaf(&data[200], 100)));
+
+		assert(tree(std::string(), 64).root() == tree::hash_leaf("", 0));
+		assert(tree("abc", 64).root() == tree::hash_leaf("abc", 3));
+		assert(tree("abc", 64).root() != hash::sha256("abc").finalize());
+
+		thread_pool pool(4);
+		tree t(data, 64, pool);
+		assert(t.leaves() == 16);
+		assert(t.root() == tree(data, 64).root());
+
+		for (std::size_t i = 0; i < t.leaves(); ++i) {
+			const std::size_t size = std::min<std::size_t>(64, data.size() - i * 64);
+			const auto proof       = t.proof(i);
+			assert(tree::verify(t.root(), &data[i * 64], size, proof));
+			assert(!tree::verify(t.root(), &data[i * 64], size - 1, proof));
+		}
+
+		// changing one chunk only rehashes its path
+		data[500] ^= 1;
+		t.update_leaf(500 / 64, &data[448], 64);
+		assert(t.root() == tree(data, 64).root());
+		assert(tree::verify(t.root(), &data[448], 64, t.proof(7)));
+
+		// many more leaves than tasks, split into uneven ranges
+		assert(tree(data, 7, pool).root() == tree(data, 7).root());
+
+		const tree t13(data, 77, pool);
+		for (std::size_t i = 0; i < t13.leaves(); ++i) {
+			assert(tree::verify(t13.root(), t13.leaf(i), t13.proof(i)));
+			assert(!tree::verify(t13.root(), t13.leaf((i + 1) % t13.leaves()), t13.proof(i)));
+		}
+	}
+
+	// --------------------- Test multi_hasher ---------------------
+	{
+		std::string data(100000, '\0');
+		for (std::size_t i = 0; i < data.size(); ++i) {
+			data[i] = static_cast<char>(i * 13 + 5);
+		}
+
+		using hasher = hash::multi_hasher<hash::crc32, hash::md5, hash::sha1>;
+
+		hasher h(data);
+		const hasher::digest d = h.finalize();
+		assert(std::get<0>(d) == hash::crc32(data).finalize());
+		assert(std::get<1>(d) == hash::md5(data).finalize());
+		assert(std::get<2>(d) == hash::sha1(data).finalize());
+
+		// streamed in odd sized pieces, and through a non-contiguous iterator
+		hasher h2;
+		for (std::size_t i = 0; i < data.size(); i += 777) {
+			h2.update(data.data() + i, std::min<std::size_t>(777, data.size() - i));
+		}
+		assert(h2.finalize() == d);
+
+		const std::list<char> list(data.begin(), data.end());
+		assert(hasher(list.begin(), list.end()).finalize() == d);
+
+		h.update('!');
+		assert(std::get<2>(h.finalize()) == hash::sha1(data + "!").finalize());
+		assert(h.get<1>().finalize() == hash::md5(data + "!").finalize());
+
+		h.clear();
+		assert(std::get<1>(h.finalize()) == hash::md5().finalize());
+	}
+
+	// --------------------- Test hash_file ---------------------
+	{
+		std::string data(3000000, '\0');
+		for (std::size_t i = 0; i < data.size(); ++i) {
+			data[i] = static_cast<char>(i * 17 + i / 4096);
+		}
+
+		char path[] = "/tmp/cpp-utilities-hash-XXXXXX";
+		const int fd = mkstemp(path);
+		assert(fd != -1);
+		const ssize_t written = write(fd, data.data(), data.size());
+		assert(written == static_cast<ssize_t>(data.size()));
+		close(fd);
+
+		const auto expected = hash::sha1(data).finalize();
+
+		const auto mapped = hash::hash_file<hash::sha1>(path);
+		assert(mapped.mapped);
+		assert(mapped.bytes == data.size());
+		assert(mapped.digest == expected);
+
+		hash::hash_file_options options;
+		options.use_mmap   = false;
+		options.chunk_size = 100000;
+
+		const auto streamed = hash::hash_file<hash::sha1>(path, options);
+		assert(!streamed.mapped);
+		assert(streamed.bytes == data.size());
+		assert(streamed.digest == expected);
+
+		// several digests at once
+		const auto both = hash::hash_file<hash::multi_hasher<hash::md5, hash::sha1>>(path);
+		assert(std::get<0>(both.digest) == hash::md5(data).finalize());
+		assert(std::get<1>(both.digest) == expected);
+		unlink(path);
+
+		// pipes can't be mapped, so are read a piece at a time as the data arrives
+		int fds[2];
+		const int r = pipe(fds);
+		assert(r == 0);
+		std::thread writer([&]() {
+			for (std::size_t i = 0; i < data.size(); i += 65536) {
+				const std::size_t n = std::min<std::size_t>(65536, data.size() - i);
+				const ssize_t w     = write(fds[1], data.data() + i, n);
+				assert(w == static_cast<ssize_t>(n));
+			}
+			close(fds[1]);
+		});
+
+		const auto piped = hash::hash_file<hash::sha1>(fds[0]);
+		writer.join();
+		close(fds[0]);
+		assert(!piped.mapped);
+		assert(piped.bytes == data.size());
+		assert(piped.digest == expected);
+
+		bool thrown = false;
+		try {
+			hash::hash_file<hash::md5>("/nonexistent/cpp-utilities");
+		} catch (const std::system_error &) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	// --------------------- Test content defined chunking ---------------------
+	{
+		std::string data(1000000, '\0');
+		uint64_t x = 1;
+		for (char &ch : data) {
+			x  = x * 6364136223846793005 + 1442695040888963407;
+			ch = static_cast<char>(x >> 56);
+		}
+
+		hash::chunker_options options;
+		options.min_size = 1024;
+		options.avg_size = 4096;
+		options.max_size = 16384;
+		options.digest   = true;
+
+		const std::vector<hash::chunk> chunks = hash::chunk_buffer(data.data(), data.size(), options);
+		assert(chunks.size() > 100);
+
+		uint64_t offset = 0;
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			const hash::chunk &c = chunks[i];
+			assert(c.offset == offset);
+			assert(c.size <= options.max_size);
+			assert(c.size >= options.min_size || i + 1 == chunks.size());
+			assert(c.digest == hash::sha1(data.substr(c.offset, c.size)).finalize());
+			offset += c.size;
+		}
+		assert(offset == data.size());
+
+		// the same boundaries no matter how the data is fed in
+		std::vector<hash::chunk> streamed;
+		auto add = [&streamed](const hash::chunk &c) {
+			streamed.push_back(c);
+		};
+
+		hash::chunker chunker(options);
+		for (std::size_t i = 0; i < data.size(); i += 1000) {
+			chunker.update(data.data() + i, std::min<std::size_t>(1000, data.size() - i), add);
+		}
+		chunker.flush(add);
+
+		assert(streamed.size() == chunks.size());
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			assert(streamed[i].offset == chunks[i].offset && streamed[i].size == chunks[i].size);
+			assert(streamed[i].digest == chunks[i].digest);
+		}
+
+		// an insertion only disturbs the chunks around it, the rest line up again
+		const std::string edited                = data.substr(0, 5000) + "inserted" + data.substr(5000);
+		const std::vector<hash::chunk> rechunked = hash::chunk_buffer(edited.data(), edited.size(), options);
+
+		std::size_t same = 0;
+		for (const hash::chunk &c : rechunked) {
+			for (const hash::chunk &original : chunks) {
+				if (c.digest == original.digest) {
+					++same;
+					break;
+				}
+			}
+		}
+		assert(same + 3 >= chunks.size());
+
+		// a zero filled buffer has no content boundaries at all
+		const std::string zeros(100000, '\0');
+		for (const hash::chunk &c : hash::chunk_buffer(zeros.data(), zeros.size(), options)) {
+			assert(c.size == options.max_size || c.offset + c.size == zeros.size());
+		}
+	}
 }
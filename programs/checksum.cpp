@@ -0,0 +1,548 @@
+/*
+ * Computes (or verifies) the CRC32, MD5 or SHA1 of many files in parallel.
+ * Output is in the same format as sha1sum/md5sum, so either tool can check
+ * the other's output.
+ *
+ * usage: checksum [-a crc32|md5|sha1] [-j THREADS] [FILE|DIRECTORY]...
+ *        checksum --check [-a crc32|md5|sha1] [-j THREADS] [--quiet] [FILE]...
+ *
+ * Directories are walked recursively. With no files, or when FILE is -,
+ * standard input is read. In --check mode the algorithm is taken from the
+ * length of the digests when -a isn't given.
+ *
+ * Small files are read whole and hashed in groups with md5_batch/sha1_batch,
+ * larger files each get a task of their own, biggest first, and are hashed
+ * with hash_file (mapped, in chunks).
+ */
+
+#include "cpp-utilities/crc32.h"
+#include "cpp-utilities/hash_file.h"
+#include "cpp-utilities/md5.h"
+#include "cpp-utilities/md5_batch.h"
+#include "cpp-utilities/sha1.h"
+#include "cpp-utilities/sha1_batch.h"
+#include "cpp-utilities/thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// files up to this size are read whole and hashed in batches
+constexpr std::uintmax_t SmallFile = 64 * 1024;
+
+// how many small files (or bytes of them) make up one task
+constexpr std::size_t BatchFiles = 256;
+constexpr std::size_t BatchBytes = 4 * 1024 * 1024;
+
+enum class algorithm {
+	crc32,
+	md5,
+	sha1,
+};
+
+struct options {
+	algorithm algo      = algorithm::sha1;
+	bool algo_given     = false;
+	bool check          = false;
+	bool quiet          = false;
+	std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::string> files;
+};
+
+struct job {
+	std::string path;
+	std::uintmax_t size = 0;
+	std::string digest; // hex, empty if the file couldn't be read
+	std::string error;
+};
+
+struct crc32_traits {
+	using hasher = hash::crc32;
+
+	static void batch(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, hasher::digest *out) {
+		for (std::size_t i = 0; i < count; ++i) {
+			out[i] = hasher().update(data[i], sizes[i]).finalize();
+		}
+	}
+};
+
+struct md5_traits {
+	using hasher = hash::md5;
+
+	static void batch(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, hasher::digest *out) {
+		hash::md5_batch(data, sizes, count, out);
+	}
+};
+
+struct sha1_traits {
+	using hasher = hash::sha1;
+
+	static void batch(const uint8_t *const *data, const std::size_t *sizes, std::size_t count, hasher::digest *out) {
+		hash::sha1_batch(data, sizes, count, out);
+	}
+};
+
+// runs every task on the pool and waits for them all
+void run_all(thread_pool &pool, std::vector<std::function<void()>> &tasks) {
+	countdown_latch latch(tasks.size());
+
+	for (auto &task : tasks) {
+		pool.add_worker([&]() {
+			task();
+			latch.count_down();
+		});
+	}
+
+	latch.wait();
+}
+
+// reads a whole file, returning 0 or the errno value of whatever failed
+int read_file(const std::string &path, std::string *contents) {
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		return errno;
+	}
+
+	int err = 0;
+	struct stat st;
+	if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+		contents->reserve(static_cast<std::size_t>(st.st_size));
+	}
+
+	char buffer[64 * 1024];
+	for (;;) {
+		const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+		if (n == 0) {
+			break;
+		}
+
+		if (n == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			err = errno;
+			break;
+		}
+
+		contents->append(buffer, static_cast<std::size_t>(n));
+	}
+
+	::close(fd);
+	return err;
+}
+
+template <class Traits>
+void hash_small_files(job *const *jobs, std::size_t count) {
+	using digest = typename Traits::hasher::digest;
+
+	std::vector<std::string> contents(count);
+	std::vector<const uint8_t *> data;
+	std::vector<std::size_t> sizes;
+	std::vector<job *> readable;
+
+	for (std::size_t i = 0; i < count; ++i) {
+		if (const int err = read_file(jobs[i]->path, &contents[i])) {
+			jobs[i]->error = std::generic_category().message(err);
+			continue;
+		}
+
+		data.push_back(reinterpret_cast<const uint8_t *>(contents[i].data()));
+		sizes.push_back(contents[i].size());
+		readable.push_back(jobs[i]);
+	}
+
+	std::vector<digest> digests(readable.size());
+	Traits::batch(data.data(), sizes.data(), readable.size(), digests.data());
+
+	for (std::size_t i = 0; i < readable.size(); ++i) {
+		readable[i]->digest = digests[i].to_string();
+	}
+}
+
+template <class Traits>
+void hash_large_file(job *j) {
+	try {
+		if (j->path == "-") {
+			j->digest = hash::hash_file<typename Traits::hasher>(0).digest.to_string();
+		} else {
+			j->digest = hash::hash_file<typename Traits::hasher>(j->path).digest.to_string();
+		}
+	} catch (const std::system_error &e) {
+		j->error = e.code().message();
+	}
+}
+
+/*
+ * fills in the digest (or error) of every job. Small files are grouped into
+ * batches, large ones get a task each and are started first so that a big
+ * file found late doesn't leave the other threads idle at the end
+ */
+template <class Traits>
+void hash_jobs(std::vector<job> &jobs, thread_pool &pool) {
+	std::vector<job *> small;
+	std::vector<job *> large;
+
+	for (job &j : jobs) {
+		if (j.path != "-" && j.size <= SmallFile) {
+			small.push_back(&j);
+		} else {
+			large.push_back(&j);
+		}
+	}
+
+	std::stable_sort(large.begin(), large.end(), [](const job *a, const job *b) {
+		return a->size > b->size;
+	});
+
+	std::vector<std::function<void()>> tasks;
+	for (job *j : large) {
+		// stdin can only be read once, and by one task
+		if (j->path != "-") {
+			tasks.emplace_back([j]() {
+				hash_large_file<Traits>(j);
+			});
+		}
+	}
+
+	std::size_t first = 0;
+	std::size_t bytes = 0;
+	for (std::size_t i = 0; i < small.size(); ++i) {
+		bytes += small[i]->size;
+		if (i + 1 == small.size() || i + 1 - first == BatchFiles || bytes >= BatchBytes) {
+			job *const *batch       = &small[first];
+			const std::size_t count = i + 1 - first;
+			tasks.emplace_back([batch, count]() {
+				hash_small_files<Traits>(batch, count);
+			});
+
+			first = i + 1;
+			bytes = 0;
+		}
+	}
+
+	run_all(pool, tasks);
+
+	for (job *j : large) {
+		if (j->path == "-") {
+			hash_large_file<Traits>(j);
+		}
+	}
+}
+
+void hash_jobs(std::vector<job> &jobs, algorithm algo, thread_pool &pool) {
+	switch (algo) {
+	case algorithm::crc32:
+		hash_jobs<crc32_traits>(jobs, pool);
+		break;
+	case algorithm::md5:
+		hash_jobs<md5_traits>(jobs, pool);
+		break;
+	case algorithm::sha1:
+		hash_jobs<sha1_traits>(jobs, pool);
+		break;
+	}
+}
+
+// like coreutils, names with a backslash or newline are escaped, and the line marked with a leading backslash
+bool needs_escape(const std::string &name) {
+	return name.find_first_of("\\\n") != std::string::npos;
+}
+
+std::string escape(const std::string &name) {
+	std::string escaped;
+	for (char ch : name) {
+		if (ch == '\\') {
+			escaped += "\\\\";
+		} else if (ch == '\n') {
+			escaped += "\\n";
+		} else {
+			escaped += ch;
+		}
+	}
+	return escaped;
+}
+
+std::string unescape(const std::string &name) {
+	std::string unescaped;
+	for (std::size_t i = 0; i < name.size(); ++i) {
+		if (name[i] == '\\' && i + 1 < name.size()) {
+			++i;
+			unescaped += (name[i] == 'n') ? '\n' : name[i];
+		} else {
+			unescaped += name[i];
+		}
+	}
+	return unescaped;
+}
+
+std::size_t digest_length(algorithm algo) {
+	switch (algo) {
+	case algorithm::crc32:
+		return hash::crc32::digest::HexSize;
+	case algorithm::md5:
+		return hash::md5::digest::HexSize;
+	case algorithm::sha1:
+		break;
+	}
+	return hash::sha1::digest::HexSize;
+}
+
+bool is_hex(const std::string &s) {
+	return !s.empty() && std::all_of(s.begin(), s.end(), [](char ch) {
+		return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+	});
+}
+
+// expands directories into the regular files below them, in a stable order
+bool collect_files(const std::vector<std::string> &paths, std::vector<job> *jobs) {
+	bool ok = true;
+
+	for (const std::string &path : paths) {
+		job j;
+		j.path = path;
+
+		if (path == "-") {
+			jobs->push_back(j);
+			continue;
+		}
+
+		std::error_code ec;
+		if (std::filesystem::is_directory(path, ec)) {
+			std::vector<std::string> files;
+			for (auto it = std::filesystem::recursive_directory_iterator(path, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+				if (it->is_regular_file(ec)) {
+					files.push_back(it->path().string());
+				}
+			}
+
+			if (ec) {
+				std::cerr << "checksum: " << path << ": " << ec.message() << "\n";
+				ok = false;
+			}
+
+			std::sort(files.begin(), files.end());
+			for (std::string &file : files) {
+				j.path = std::move(file);
+				j.size = std::filesystem::file_size(j.path, ec);
+				jobs->push_back(j);
+			}
+			continue;
+		}
+
+		j.size = std::filesystem::file_size(path, ec);
+		if (ec) {
+			// not a regular file (a pipe, for instance), so treat it as a large one
+			j.size = SmallFile + 1;
+		}
+		jobs->push_back(j);
+	}
+
+	return ok;
+}
+
+int compute(const options &opts, thread_pool &pool) {
+	std::vector<job> jobs;
+	bool ok = collect_files(opts.files, &jobs);
+
+	hash_jobs(jobs, opts.algo, pool);
+
+	for (const job &j : jobs) {
+		if (!j.error.empty()) {
+			std::cerr << "checksum: " << j.path << ": " << j.error << "\n";
+			ok = false;
+			continue;
+		}
+
+		if (needs_escape(j.path)) {
+			std::cout << '\\' << j.digest << "  " << escape(j.path) << "\n";
+		} else {
+			std::cout << j.digest << "  " << j.path << "\n";
+		}
+	}
+
+	return ok ? 0 : 1;
+}
+
+int check(const options &opts, thread_pool &pool) {
+	std::vector<job> jobs;
+	std::vector<std::string> expected;
+	std::size_t malformed = 0;
+
+	bool algo_known = opts.algo_given;
+	algorithm algo  = opts.algo;
+
+	for (const std::string &list : opts.files) {
+		std::string contents;
+		if (list != "-") {
+			if (const int err = read_file(list, &contents)) {
+				std::cerr << "checksum: " << list << ": " << std::generic_category().message(err) << "\n";
+				return 1;
+			}
+		}
+
+		std::istringstream file_stream(contents);
+
+		std::istream &in = (list == "-") ? std::cin : file_stream;
+
+		std::string line;
+		while (std::getline(in, line)) {
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+
+			const bool escaped = !line.empty() && line[0] == '\\';
+			if (escaped) {
+				line.erase(0, 1);
+			}
+
+			// "<digest>  <name>" for text mode, "<digest> *<name>" for binary
+			const std::size_t space = line.find(' ');
+			if (space == std::string::npos || space + 2 > line.size() || (line[space + 1] != ' ' && line[space + 1] != '*') || !is_hex(line.substr(0, space))) {
+				++malformed;
+				continue;
+			}
+
+			std::string digest = line.substr(0, space);
+			std::transform(digest.begin(), digest.end(), digest.begin(), [](char ch) {
+				return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+			});
+
+			if (!algo_known) {
+				if (digest.size() == hash::crc32::digest::HexSize) {
+					algo = algorithm::crc32;
+				} else if (digest.size() == hash::md5::digest::HexSize) {
+					algo = algorithm::md5;
+				} else {
+					algo = algorithm::sha1;
+				}
+				algo_known = true;
+			}
+
+			if (digest.size() != digest_length(algo)) {
+				++malformed;
+				continue;
+			}
+
+			job j;
+			j.path = line.substr(space + 2);
+			if (escaped) {
+				j.path = unescape(j.path);
+			}
+
+			std::error_code ec;
+			j.size = std::filesystem::file_size(j.path, ec);
+			if (ec) {
+				j.size = SmallFile + 1;
+			}
+
+			jobs.push_back(j);
+			expected.push_back(digest);
+		}
+	}
+
+	hash_jobs(jobs, algo, pool);
+
+	std::size_t failed     = 0;
+	std::size_t unreadable = 0;
+	for (std::size_t i = 0; i < jobs.size(); ++i) {
+		const job &j = jobs[i];
+		if (!j.error.empty()) {
+			std::cerr << "checksum: " << j.path << ": " << j.error << "\n";
+			std::cout << j.path << ": FAILED open or read\n";
+			++unreadable;
+		} else if (j.digest != expected[i]) {
+			std::cout << j.path << ": FAILED\n";
+			++failed;
+		} else if (!opts.quiet) {
+			std::cout << j.path << ": OK\n";
+		}
+	}
+
+	if (malformed != 0) {
+		std::cerr << "checksum: WARNING: " << malformed << " line" << (malformed == 1 ? " is" : "s are") << " improperly formatted\n";
+	}
+
+	if (unreadable != 0) {
+		std::cerr << "checksum: WARNING: " << unreadable << " listed file" << (unreadable == 1 ? "" : "s") << " could not be read\n";
+	}
+
+	if (failed != 0) {
+		std::cerr << "checksum: WARNING: " << failed << " computed checksum" << (failed == 1 ? "" : "s") << " did NOT match\n";
+	}
+
+	if (jobs.empty()) {
+		std::cerr << "checksum: no properly formatted checksum lines found\n";
+		return 1;
+	}
+
+	return (failed == 0 && unreadable == 0) ? 0 : 1;
+}
+
+void usage(const char *argv0) {
+	std::cerr << "usage: " << argv0 << " [-a crc32|md5|sha1] [-j THREADS] [FILE|DIRECTORY]...\n";
+	std::cerr << "       " << argv0 << " --check [-a crc32|md5|sha1] [-j THREADS] [--quiet] [FILE]...\n";
+}
+
+}
+
+int main(int argc, char *argv[]) {
+
+	options opts;
+
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+
+		if ((std::strcmp(argv[i], "-a") == 0 || std::strcmp(argv[i], "--algorithm") == 0) && has_value) {
+			const std::string name = argv[++i];
+			if (name == "crc32") {
+				opts.algo = algorithm::crc32;
+			} else if (name == "md5") {
+				opts.algo = algorithm::md5;
+			} else if (name == "sha1") {
+				opts.algo = algorithm::sha1;
+			} else {
+				usage(argv[0]);
+				return 1;
+			}
+			opts.algo_given = true;
+		} else if ((std::strcmp(argv[i], "-j") == 0 || std::strcmp(argv[i], "--threads") == 0) && has_value) {
+			opts.threads = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "-c") == 0 || std::strcmp(argv[i], "--check") == 0) {
+			opts.check = true;
+		} else if (std::strcmp(argv[i], "--quiet") == 0) {
+			opts.quiet = true;
+		} else if (std::strcmp(argv[i], "--") == 0) {
+			opts.files.insert(opts.files.end(), argv + i + 1, argv + argc);
+			break;
+		} else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			opts.files.push_back(argv[i]);
+		}
+	}
+
+	if (opts.files.empty()) {
+		opts.files.push_back("-");
+	}
+
+	thread_pool pool(opts.threads);
+
+	return opts.check ? check(opts, pool) : compute(opts, pool);
+}
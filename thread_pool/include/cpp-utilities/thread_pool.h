@@ -11,6 +11,42 @@
 #include <thread>
 #include <vector>
 
+/**
+ * A single use countdown, for waiting on a known number of tasks given to a
+ * thread_pool. Each task calls count_down() when it is finished, and wait()
+ * blocks until all of them have
+ */
+class countdown_latch {
+public:
+	explicit countdown_latch(std::size_t count)
+		: count_(count) {
+	}
+
+	countdown_latch(const countdown_latch &)            = delete;
+	countdown_latch &operator=(const countdown_latch &) = delete;
+
+public:
+	void count_down() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		assert(count_ != 0 && "count_down called too many times");
+		if (--count_ == 0) {
+			done_.notify_all();
+		}
+	}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [this]() {
+			return count_ == 0;
+		});
+	}
+
+private:
+	std::size_t count_;
+	std::mutex mutex_;
+	std::condition_variable done_;
+};
+
 class thread_pool {
 public:
 	using work_type = std::function<void()>;
@@ -79,6 +115,13 @@ public:
 		queue_condition_.notify_one();
 	}
 
+	/**
+	 * @return the number of threads in the pool
+	 */
+	std::size_t size() const {
+		return threads_.size();
+	}
+
 	/**
 	 * Waits until there is at least one work item to do, and then returns
 	 * the work item after popping it off the queue
@@ -1,6 +1,25 @@
 #include <cpp-utilities/thread_pool.h>
+#include <atomic>
+#include <cassert>
 #include <iostream>
 
 int main() {
 	thread_pool pool;
+
+	// a latch waits for every task given to the pool
+	{
+		std::atomic<int> sum(0);
+		countdown_latch latch(100);
+		for (int i = 1; i <= 100; ++i) {
+			pool.add_worker([&, i]() {
+				sum += i;
+				latch.count_down();
+			});
+		}
+		latch.wait();
+		assert(sum == 5050);
+
+		countdown_latch none(0);
+		none.wait();
+	}
 }